@@ -0,0 +1,39 @@
+#include "AllocationCounter.hh"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<std::uint64_t> totalAllocations(0);
+    thread_local std::uint64_t threadAllocations = 0;
+}
+
+void *operator new(std::size_t size)
+{
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    threadAllocations++;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+std::uint64_t totalAllocationCount()
+{
+    return totalAllocations.load(std::memory_order_relaxed);
+}
+
+std::uint64_t threadAllocationCount()
+{
+    return threadAllocations;
+}
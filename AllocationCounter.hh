@@ -0,0 +1,14 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+
+// Compteurs d'allocations : AllocationCounter.cpp remplace l'operator new global.
+// Ce fichier n'est lié qu'aux programmes qui mesurent (banc d'essai, profilage).
+
+// Nombre d'appels à operator new depuis le démarrage, tous threads confondus
+std::uint64_t totalAllocationCount();
+// Idem pour le thread appelant seulement
+std::uint64_t threadAllocationCount();
+
+#endif // ALLOCATIONCOUNTER_H
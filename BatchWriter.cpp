@@ -0,0 +1,135 @@
+#include "BatchWriter.hh"
+#include "heightmap.hh"
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    // En-tête P6 commun à toutes les images d'un ImageWriter
+    std::string ppmHeader(int width, int height)
+    {
+        std::ostringstream header;
+        header << "P6\n" << width << " " << height << "\n255\n";
+        return header.str();
+    }
+}
+
+PPMFrameSink::PPMFrameSink(const std::string &directory, int resolution)
+    : directory(directory), resolution(resolution)
+{
+}
+
+void PPMFrameSink::writeFrame(int frame, Span<float> heights, Span<const std::complex<float>>)
+{
+    normalizeHeightMap(heights);
+    encodePPM(heights, resolution, bytes);
+
+    // Une seule écriture par image, sans flush intermédiaire
+    const std::string filename = frameFileName(directory, frame);
+    std::FILE *file = std::fopen(filename.c_str(), "wb");
+    if (!file)
+        throw std::runtime_error("PPMFrameSink: impossible d'ouvrir " + filename);
+    const std::size_t written = std::fwrite(bytes.data(), 1, bytes.size(), file);
+    const bool closed = std::fclose(file) == 0;
+    if (written != bytes.size() || !closed)
+        throw std::runtime_error("PPMFrameSink: écriture incomplète de " + filename);
+}
+
+std::string PPMFrameSink::frameFileName(const std::string &directory, int frame)
+{
+    std::ostringstream name;
+    if (!directory.empty())
+        name << directory << '/';
+    name << "heightmap_" << std::setfill('0') << std::setw(4) << frame << ".ppm";
+    return name.str();
+}
+
+BatchWriter::BatchWriter(FrameSink &sink, int resolution, bool withDisplacements, int slotCount)
+    : sink(sink), cellCount(static_cast<std::size_t>(resolution) * resolution), withDisplacements(withDisplacements),
+      queue(slotCount,
+            [this](Slot &slot)
+            {
+                slot.heights.resize(cellCount);
+                if (this->withDisplacements)
+                    slot.displacements.resize(cellCount);
+            },
+            [this](Slot &slot) { write(slot); })
+{
+}
+
+void BatchWriter::push(int frame, Span<const float> heights, Span<const std::complex<float>> displacements)
+{
+    if (heights.size() != cellCount || (withDisplacements && displacements.size() != cellCount))
+        throw std::invalid_argument("BatchWriter: taille de frame incorrecte");
+
+    // Copie hors verrou : le thread d'écriture continue sur les autres tampons
+    Slot &slot = queue.acquire();
+    slot.frame = frame;
+    std::copy(heights.begin(), heights.end(), slot.heights.begin());
+    if (withDisplacements)
+        std::copy(displacements.begin(), displacements.end(), slot.displacements.begin());
+    queue.submit(slot);
+}
+
+void BatchWriter::finish()
+{
+    queue.finish();
+}
+
+void BatchWriter::write(Slot &slot)
+{
+    sink.writeFrame(slot.frame, Span<float>(slot.heights.data(), slot.heights.size()),
+                    Span<const std::complex<float>>(slot.displacements.data(), slot.displacements.size()));
+}
+
+ImageWriter::ImageWriter(const std::string &directory, int width, int height, int slotCount)
+    : directory(directory), width(width), height(height), header(ppmHeader(width, height)),
+      queue(slotCount,
+            [this](Slot &slot)
+            {
+                slot.bytes.assign(header.begin(), header.end());
+                slot.bytes.resize(header.size() + static_cast<std::size_t>(this->width) * this->height * 3);
+            },
+            [this](Slot &slot) { write(slot); })
+{
+}
+
+void ImageWriter::push(int frame, Span<const unsigned char> rgb)
+{
+    if (rgb.size() != static_cast<std::size_t>(width) * height * 3)
+        throw std::invalid_argument("ImageWriter: taille d'image incorrecte");
+
+    Slot &slot = queue.acquire();
+    slot.frame = frame;
+    std::copy(rgb.begin(), rgb.end(), slot.bytes.begin() + header.size());
+    queue.submit(slot);
+}
+
+void ImageWriter::finish()
+{
+    queue.finish();
+}
+
+void ImageWriter::write(Slot &slot)
+{
+    const std::string filename = imageFileName(directory, slot.frame);
+    std::FILE *file = std::fopen(filename.c_str(), "wb");
+    if (!file)
+        throw std::runtime_error("ImageWriter: impossible d'ouvrir " + filename);
+    const std::size_t written = std::fwrite(slot.bytes.data(), 1, slot.bytes.size(), file);
+    const bool closed = std::fclose(file) == 0;
+    if (written != slot.bytes.size() || !closed)
+        throw std::runtime_error("ImageWriter: écriture incomplète de " + filename);
+}
+
+std::string ImageWriter::imageFileName(const std::string &directory, int frame)
+{
+    std::ostringstream name;
+    if (!directory.empty())
+        name << directory << '/';
+    name << "ocean_" << std::setfill('0') << std::setw(4) << frame << ".ppm";
+    return name.str();
+}
@@ -0,0 +1,216 @@
+#ifndef BATCHWRITER_H
+#define BATCHWRITER_H
+
+#include <complex>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Span.hh"
+
+// Destination des frames du générateur hors ligne, appelée depuis le thread d'écriture.
+// heights est une copie que le sink peut modifier ; displacements est vide si
+// le BatchWriter ne transporte pas les déplacements.
+class FrameSink
+{
+public:
+    virtual ~FrameSink() {}
+    virtual void writeFrame(int frame, Span<float> heights, Span<const std::complex<float>> displacements) = 0;
+};
+
+// Un fichier heightmap_XXXX.ppm par frame, hauteurs normalisées
+class PPMFrameSink : public FrameSink
+{
+private:
+    std::string directory;
+    int resolution;
+    std::vector<unsigned char> bytes; // Image encodée, réutilisée d'une frame à l'autre
+
+public:
+    PPMFrameSink(const std::string &directory, int resolution);
+    void writeFrame(int frame, Span<float> heights, Span<const std::complex<float>> displacements) override;
+
+    static std::string frameFileName(const std::string &directory, int frame);
+};
+
+// Tampons et thread d'écriture communs à BatchWriter et ImageWriter : acquire()
+// réserve un tampon libre, que l'appelant remplit puis confie à submit() ; le
+// thread dédié le passe à write puis le rend. Après une erreur de write, les
+// tampons restants sont abandonnés et la première erreur est relancée par
+// acquire() ou finish().
+template <typename Slot>
+class WriterQueue
+{
+private:
+    std::vector<Slot> slots;
+    std::deque<Slot *> freeSlots;
+    std::deque<Slot *> readySlots;
+    std::mutex mutex;
+    std::condition_variable slotFreed;
+    std::condition_variable slotReady;
+    bool finished;
+    std::exception_ptr error;
+    std::function<void(Slot &)> write;
+    std::thread worker;
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+        }
+        slotReady.notify_one();
+        if (worker.joinable())
+            worker.join();
+    }
+
+    void writerLoop()
+    {
+        for (;;)
+        {
+            Slot *slot;
+            bool failed;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                slotReady.wait(lock, [this] { return !readySlots.empty() || finished; });
+                if (readySlots.empty())
+                    return;
+                slot = readySlots.front();
+                readySlots.pop_front();
+                failed = static_cast<bool>(error);
+            }
+
+            // Après une erreur, les frames restantes sont abandonnées
+            try
+            {
+                if (!failed)
+                    write(*slot);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                freeSlots.push_back(slot);
+            }
+            slotFreed.notify_one();
+        }
+    }
+
+public:
+    // prepare est appelé sur chaque tampon avant le démarrage du thread d'écriture
+    template <typename Prepare>
+    WriterQueue(int slotCount, Prepare prepare, std::function<void(Slot &)> writeSlot)
+        : slots(slotCount > 1 ? slotCount : 1), finished(false), write(std::move(writeSlot))
+    {
+        for (Slot &slot : slots)
+        {
+            prepare(slot);
+            freeSlots.push_back(&slot);
+        }
+        worker = std::thread(&WriterQueue::writerLoop, this);
+    }
+
+    ~WriterQueue() { stop(); }
+    WriterQueue(const WriterQueue &) = delete;
+    WriterQueue &operator=(const WriterQueue &) = delete;
+
+    Slot &acquire()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        slotFreed.wait(lock, [this] { return !freeSlots.empty() || error; });
+        if (error)
+            std::rethrow_exception(error);
+        Slot *slot = freeSlots.front();
+        freeSlots.pop_front();
+        return *slot;
+    }
+
+    void submit(Slot &slot)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            readySlots.push_back(&slot);
+        }
+        slotReady.notify_one();
+    }
+
+    // Attend l'écriture de tous les tampons confiés
+    void finish()
+    {
+        stop();
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+// Étage d'écriture du générateur hors ligne : les frames sont copiées dans
+// l'un des slotCount tampons puis passées au sink par un thread dédié, pendant
+// que la frame suivante est calculée.
+// push() ne bloque que si tous les tampons attendent encore d'être écrits.
+class BatchWriter
+{
+private:
+    struct Slot
+    {
+        int frame;
+        std::vector<float> heights;
+        std::vector<std::complex<float>> displacements;
+    };
+
+    FrameSink &sink;
+    std::size_t cellCount;
+    bool withDisplacements;
+    WriterQueue<Slot> queue; // Dernier membre : son thread s'arrête avant la destruction des autres
+
+    void write(Slot &slot);
+
+public:
+    BatchWriter(FrameSink &sink, int resolution, bool withDisplacements = false, int slotCount = 4);
+    BatchWriter(const BatchWriter &) = delete;
+    BatchWriter &operator=(const BatchWriter &) = delete;
+
+    void push(int frame, Span<const float> heights, Span<const std::complex<float>> displacements = Span<const std::complex<float>>());
+    void finish(); // Attend l'écriture de toutes les frames
+};
+
+// Même étage d'écriture pour les images RGB du rendu logiciel : un fichier
+// ocean_XXXX.ppm par frame, écrit par un thread dédié pendant le calcul et le
+// rendu de la frame suivante
+class ImageWriter
+{
+private:
+    struct Slot
+    {
+        int frame;
+        std::vector<unsigned char> bytes; // En-tête PPM puis pixels
+    };
+
+    std::string directory;
+    int width;
+    int height;
+    std::string header;
+    WriterQueue<Slot> queue;
+
+    void write(Slot &slot);
+
+public:
+    ImageWriter(const std::string &directory, int width, int height, int slotCount = 4);
+    ImageWriter(const ImageWriter &) = delete;
+    ImageWriter &operator=(const ImageWriter &) = delete;
+
+    void push(int frame, Span<const unsigned char> rgb); // width * height * 3 octets, lignes de haut en bas
+    void finish();
+
+    static std::string imageFileName(const std::string &directory, int frame);
+};
+
+#endif // BATCHWRITER_H
@@ -1,27 +1,32 @@
 #include "Camera.hh"
-#include <GL/glew.h>
-#include <GL/freeglut.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
 #include <cmath>
 
 Camera::Camera(float x, float y, float z)
-    : posX(x), posY(y), posZ(z), yaw(0.0f), pitch(0.0f), zoomFactor(1.0f)
+    : posX(x), posY(y), posZ(z), yaw(0.0f), pitch(0.0f), roll(0.0f), zoomFactor(1.0f)
 {
 }
 
 void Camera::init()
 {
     // Initialisez la caméra avec un angle de vue légèrement vers le bas
-    pitch = 20.0f;
+    pitch = -20.0f;
 }
 
-void Camera::update()
+glm::mat4 Camera::viewMatrix() const
 {
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    glRotatef(-pitch, 1.0f, 0.0f, 0.0f); // Inverser la rotation pitch
-    glRotatef(-yaw, 0.0f, 1.0f, 0.0f);   // Inverser la rotation yaw
-    glRotatef(-roll, 0.0f, 0.0f, 1.0f);  // Inverser la rotation roll
-    glTranslatef(-posX, -posY, -posZ);
+    glm::mat4 view(1.0f);
+    view = glm::rotate(view, glm::radians(-pitch), glm::vec3(1.0f, 0.0f, 0.0f)); // Inverser la rotation pitch
+    view = glm::rotate(view, glm::radians(-yaw), glm::vec3(0.0f, 1.0f, 0.0f));   // Inverser la rotation yaw
+    view = glm::rotate(view, glm::radians(-roll), glm::vec3(0.0f, 0.0f, 1.0f));  // Inverser la rotation roll
+    return glm::translate(view, glm::vec3(-posX, -posY, -posZ));
+}
+
+glm::mat4 Camera::projectionMatrix(float aspect, float nearPlane, float farPlane) const
+{
+    const float fieldOfView = std::min(60.0f / zoomFactor, 170.0f);
+    return glm::perspective(glm::radians(fieldOfView), aspect, nearPlane, farPlane);
 }
 
 void Camera::moveUp(float distance)
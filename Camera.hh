@@ -1,3 +1,10 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include <glm/glm.hpp>
+
+// Caméra libre : position et angles (en degrés). Les matrices sont calculées
+// avec glm, sans appel OpenGL.
 class Camera
 {
 private:
@@ -11,7 +18,6 @@ private:
 
 public:
     Camera(float x, float y, float z); // Constructeur
-    void update();                     // Mettre à jour les transformations de la caméra
     void moveForward(float distance);  // Déplacer la caméra vers l'avant
     void moveBackward(float distance); // Déplacer la caméra vers l'arrière
     void moveLeft(float distance);     // Déplacer la caméra vers la gauche
@@ -26,4 +32,11 @@ public:
     float getX() const;
     float getY() const;
     float getZ() const;
+
+    // Équivalent de glRotatef(-pitch, x), glRotatef(-yaw, y), glRotatef(-roll, z), glTranslatef(-position)
+    glm::mat4 viewMatrix() const;
+    // Perspective dont le champ vertical (60 degrés) est divisé par le facteur de zoom
+    glm::mat4 projectionMatrix(float aspect, float nearPlane, float farPlane) const;
 };
+
+#endif // CAMERA_H
@@ -0,0 +1,116 @@
+#include "FFTPlan.hh"
+#include "SimdKernels.hh"
+#include "Resolution.hh"
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+template <typename Real>
+BasicFFTPlan<Real>::BasicFFTPlan(int size)
+    : n(size), log2n(0)
+{
+    if (n <= 0 || (n & (n - 1)) != 0)
+        throw std::invalid_argument("FFTPlan: la taille doit être une puissance de deux");
+
+    while ((1 << log2n) < n)
+        log2n++;
+
+    // Permutation bit-reverse : on ne garde que les échanges utiles
+    for (int i = 0; i < n; ++i)
+    {
+        int rev = 0;
+        for (int b = 0; b < log2n; ++b)
+        {
+            if (i & (1 << b))
+                rev |= 1 << (log2n - 1 - b);
+        }
+        if (i < rev)
+            swaps.push_back(std::make_pair(i, rev));
+    }
+
+    // Twiddles calculés en double puis arrondis au type de calcul
+    for (int half = (log2n % 2 == 1) ? 2 : 1; 4 * half <= n; half *= 4)
+    {
+        for (int k = 0; k < half; ++k)
+            twiddles.push_back(ComplexT(std::polar(1.0, 2.0 * M_PI * k / (2 * half))));
+        for (int k = 0; k < half; ++k)
+            twiddles.push_back(ComplexT(std::polar(1.0, 2.0 * M_PI * k / (4 * half))));
+    }
+}
+
+template <typename Real>
+int BasicFFTPlan<Real>::size() const
+{
+    return n;
+}
+
+template <typename Real>
+void BasicFFTPlan<Real>::inverse(ComplexT *data) const
+{
+    if (isSupportedResolution(n))
+    {
+        dispatchResolution(n, [&](auto size)
+        {
+            inverseSized<decltype(size)::value>(data);
+        });
+    }
+    else
+    {
+        inverseSized<0>(data);
+    }
+}
+
+template <typename Real>
+template <int N>
+void BasicFFTPlan<Real>::inverseSized(ComplexT *data) const
+{
+    const int n = N > 0 ? N : this->n;
+    const int log2n = N > 0 ? __builtin_ctz(N) : this->log2n;
+
+    for (const std::pair<int, int> &s : swaps)
+    {
+        std::swap(data[s.first], data[s.second]);
+    }
+
+    // Taille des blocs déjà transformés
+    int half = 1;
+
+    // Un étage radix-2 si log2(n) est impair, le reste en radix-4
+    if (log2n % 2 == 1)
+    {
+        for (int b = 0; b < n; b += 2)
+        {
+            const ComplexT u = data[b];
+            const ComplexT v = data[b + 1];
+            data[b] = u + v;
+            data[b + 1] = u - v;
+        }
+        half = 2;
+    }
+
+    // Chaque passe radix-4 fusionne deux étages radix-2 : blocs de taille half -> 4 * half
+    const ComplexT *w = twiddles.data();
+    for (; 4 * half <= n; half *= 4)
+    {
+        radix4PassKernel(data, n, half, w, w + half);
+        w += 2 * half;
+    }
+}
+
+template <typename Real>
+const BasicFFTPlan<Real> &BasicFFTPlan<Real>::get(int size)
+{
+    static std::map<int, std::unique_ptr<BasicFFTPlan>> plans;
+    static std::mutex mutex;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<BasicFFTPlan> &plan = plans[size];
+    if (!plan)
+        plan.reset(new BasicFFTPlan(size));
+    return *plan;
+}
+
+template class BasicFFTPlan<double>;
+template class BasicFFTPlan<float>;
@@ -0,0 +1,43 @@
+#ifndef FFTPLAN_H
+#define FFTPLAN_H
+
+#include <complex>
+#include <vector>
+#include <utility>
+
+// Plan de FFT inverse itérative et en place pour une taille puissance de deux.
+// La permutation bit-reverse et les twiddles sont calculés une seule fois à la
+// construction, puis réutilisés à chaque appel de inverse().
+// Les twiddles de chaque passe radix-4 sont rangés de façon contiguë pour que
+// les noyaux vectoriels (float) puissent les charger directement.
+template <typename Real>
+class BasicFFTPlan
+{
+public:
+    typedef std::complex<Real> ComplexT;
+
+private:
+    int n;                                  // Taille de la transformée
+    int log2n;                              // log2(n)
+    std::vector<std::pair<int, int>> swaps; // Paires (i, rev(i)) avec i < rev(i)
+    std::vector<ComplexT> twiddles;         // Pour chaque passe : w1[0..half) puis w2[0..half)
+
+    // N > 0 : taille connue à la compilation (bornes de boucle constantes), N == 0 : taille n
+    template <int N>
+    void inverseSized(ComplexT *data) const;
+
+public:
+    explicit BasicFFTPlan(int size);
+    int size() const;
+    void inverse(ComplexT *data) const; // IFFT non normalisée, en place
+
+    static const BasicFFTPlan &get(int size); // Plan partagé pour une taille donnée
+};
+
+typedef BasicFFTPlan<double> FFTPlan;
+typedef BasicFFTPlan<float> FFTPlanF;
+
+extern template class BasicFFTPlan<double>;
+extern template class BasicFFTPlan<float>;
+
+#endif // FFTPLAN_H
@@ -0,0 +1,102 @@
+#include "FrameCache.hh"
+#include "heightmap.hh"
+#include "ThreadPool.hh"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <stdexcept>
+
+FrameCache::FrameCache()
+    : resolution(0), frameCount(0), period(0)
+{
+}
+
+void FrameCache::build(const OceanStateF &source, float loopPeriod, int count)
+{
+    if (count <= 0 || !(loopPeriod > 0))
+        throw std::invalid_argument("FrameCache: période et nombre de frames doivent être positifs");
+
+    resolution = source.getResolution();
+    frameCount = count;
+    period = loopPeriod;
+    const std::size_t cells = source.cellCount();
+    samples.assign(static_cast<std::size_t>(frameCount) * cells, 0);
+    scales.assign(frameCount, 0.0f);
+
+    // Un bloc de frames par thread : les FFT de chaque frame s'exécutent alors
+    // en série dans le thread (parallelFor imbriqué), sans se disputer le pool.
+    ThreadPool &pool = ThreadPool::shared();
+    const int grain = (frameCount + pool.getThreadCount() - 1) / pool.getThreadCount();
+
+    // Un état de travail par bloc, alloué avant la répartition : les blocs
+    // commencent aux multiples de grain, le bloc first / grain prend le sien
+    const int blocks = (frameCount + grain - 1) / grain;
+    std::vector<std::unique_ptr<OceanStateF>> states;
+    for (int b = 0; b < blocks; ++b)
+        states.emplace_back(new OceanStateF(resolution));
+
+    pool.parallelFor(0, frameCount, grain, [&](int first, int last)
+    {
+        OceanStateF *work = states[first / grain].get();
+        work->copySpectrumFrom(source);
+        for (int frame = first; frame < last; ++frame)
+        {
+            UpdateHeights(frame * period / frameCount, *work);
+
+            Span<const float> heights = work->heights();
+            float maxAbs = 0.0f;
+            for (float h : heights)
+                maxAbs = std::max(maxAbs, std::abs(h));
+
+            const float scale = maxAbs > 0 ? maxAbs / 32767.0f : 1.0f;
+            const float inverse = 1.0f / scale;
+            std::int16_t *out = samples.data() + static_cast<std::size_t>(frame) * cells;
+            for (std::size_t i = 0; i < cells; ++i)
+                out[i] = static_cast<std::int16_t>(std::lround(heights[i] * inverse));
+            scales[frame] = scale;
+        }
+    });
+}
+
+bool FrameCache::empty() const
+{
+    return frameCount == 0;
+}
+
+int FrameCache::getResolution() const
+{
+    return resolution;
+}
+
+int FrameCache::getFrameCount() const
+{
+    return frameCount;
+}
+
+float FrameCache::getPeriod() const
+{
+    return period;
+}
+
+std::size_t FrameCache::byteSize() const
+{
+    return samples.size() * sizeof(std::int16_t) + scales.size() * sizeof(float);
+}
+
+void FrameCache::decode(int frame, Span<float> heights) const
+{
+    const std::size_t cells = static_cast<std::size_t>(resolution) * resolution;
+    if (empty() || heights.size() != cells)
+        throw std::invalid_argument("FrameCache: tampon de sortie de taille incorrecte");
+
+    frame %= frameCount;
+    if (frame < 0)
+        frame += frameCount;
+
+    const std::int16_t *in = samples.data() + static_cast<std::size_t>(frame) * cells;
+    const float scale = scales[frame];
+    float *out = heights.data();
+    for (std::size_t i = 0; i < cells; ++i)
+        out[i] = in[i] * scale;
+}
@@ -0,0 +1,39 @@
+#ifndef FRAMECACHE_H
+#define FRAMECACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "OceanState.hh"
+#include "Span.hh"
+
+// Frames d'une période complète d'un océan bouclant (voir QuantizeDispersion),
+// calculées une fois puis rejouées sans FFT.
+// Chaque frame est stockée en entiers 16 bits avec son propre facteur d'échelle.
+class FrameCache
+{
+private:
+    int resolution;
+    int frameCount;
+    float period;
+    std::vector<std::int16_t> samples; // frameCount * resolution² hauteurs quantifiées
+    std::vector<float> scales;         // Hauteur = sample * scales[frame]
+
+public:
+    FrameCache();
+
+    // source doit contenir un spectre aux pulsations quantifiées sur period.
+    // Les frames sont calculées en parallèle, chacune dans un état de travail par thread.
+    void build(const OceanStateF &source, float period, int frameCount);
+
+    bool empty() const;
+    int getResolution() const;
+    int getFrameCount() const;
+    float getPeriod() const;
+    std::size_t byteSize() const;
+
+    // Hauteurs de la frame frame modulo frameCount, à l'instant frame * period / frameCount
+    void decode(int frame, Span<float> heights) const;
+};
+
+#endif // FRAMECACHE_H
@@ -0,0 +1,314 @@
+#include "HeightfieldFile.hh"
+#include "heightmap.hh"
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const char HEIGHTFIELD_MAGIC[8] = {'O', 'C', 'E', 'A', 'N', 'H', 'F', '1'};
+    const std::uint32_t HEIGHTFIELD_VERSION = 1;
+    const std::size_t FRAME_ALIGNMENT = 64; // Vues float alignées comme les tampons d'OceanState
+
+    std::size_t valueSize(std::uint32_t format)
+    {
+        return format == HEIGHTFIELD_FLOAT16 ? 2 : 4;
+    }
+
+    std::size_t channelBytes(const HeightfieldHeader &header)
+    {
+        return static_cast<std::size_t>(header.resolution) * header.resolution * valueSize(header.format);
+    }
+}
+
+std::uint16_t floatToHalf(float value)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const std::uint16_t sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000);
+    const std::uint32_t magnitude = bits & 0x7fffffff;
+
+    if (magnitude >= 0x7f800000) // Infini ou NaN
+        return sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x200 : 0);
+    if (magnitude >= 0x477ff000) // Trop grand : infini
+        return sign | 0x7c00;
+    if (magnitude < 0x38800000) // Dénormalisé ou zéro
+    {
+        if (magnitude < 0x33000000)
+            return sign;
+        const std::uint32_t mantissa = (magnitude & 0x7fffff) | 0x800000;
+        const int shift = 126 - static_cast<int>(magnitude >> 23);
+        const std::uint32_t half = mantissa >> shift;
+        const std::uint32_t rest = mantissa & ((1u << shift) - 1);
+        const std::uint32_t midpoint = 1u << (shift - 1);
+        return sign | static_cast<std::uint16_t>(half + (rest > midpoint || (rest == midpoint && (half & 1))));
+    }
+
+    // Normalisé : rebiaise l'exposant et arrondit au pair le plus proche
+    const std::uint32_t rebased = magnitude - 0x38000000;
+    const std::uint32_t rounded = rebased + 0xfff + ((rebased >> 13) & 1);
+    return sign | static_cast<std::uint16_t>(rounded >> 13);
+}
+
+float halfToFloat(std::uint16_t value)
+{
+    const std::uint32_t sign = static_cast<std::uint32_t>(value & 0x8000) << 16;
+    const std::uint32_t exponent = (value >> 10) & 0x1f;
+    std::uint32_t mantissa = value & 0x3ff;
+    std::uint32_t bits;
+
+    if (exponent == 0x1f)
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    else if (exponent != 0)
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    else if (mantissa == 0)
+        bits = sign;
+    else
+    {
+        // Dénormalisé : renormalise la mantisse
+        int shift = 0;
+        while ((mantissa & 0x400) == 0)
+        {
+            mantissa <<= 1;
+            shift++;
+        }
+        bits = sign | static_cast<std::uint32_t>(113 - shift) << 23 | ((mantissa & 0x3ff) << 13);
+    }
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+HeightfieldHeader makeHeightfieldHeader(int resolution, HeightfieldFormat format, bool withDisplacements,
+                                        unsigned seed, float timeStep, const OceanParameters &parameters)
+{
+    HeightfieldHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, HEIGHTFIELD_MAGIC, sizeof(header.magic));
+    header.version = HEIGHTFIELD_VERSION;
+    header.resolution = resolution;
+    header.format = format;
+    header.channelCount = withDisplacements ? 3 : 1;
+    header.seed = seed;
+    header.patchSize = parameters.patchSize;
+    header.timeStep = timeStep;
+    header.windSpeed = parameters.windSpeed;
+    header.windDirectionX = parameters.windDirection.x;
+    header.windDirectionY = parameters.windDirection.y;
+    header.choppiness = parameters.choppiness;
+    header.gravity = GRAVITY;
+    header.pruneThreshold = parameters.pruneThreshold;
+    return header;
+}
+
+HeightfieldWriter::HeightfieldWriter(const std::string &path, const HeightfieldHeader &params)
+    : streamBuffer(1 << 20), header(params), closed(false)
+{
+    if (!isSupportedResolution(header.resolution) || (header.channelCount != 1 && header.channelCount != 3) ||
+        header.format > HEIGHTFIELD_FLOAT16)
+        throw std::invalid_argument("HeightfieldWriter: en-tête invalide");
+
+    const std::size_t frameBytes = header.channelCount * channelBytes(header);
+    header.frameStride = (frameBytes + FRAME_ALIGNMENT - 1) / FRAME_ALIGNMENT * FRAME_ALIGNMENT;
+    header.dataOffset = sizeof(HeightfieldHeader);
+    header.frameCount = 0;
+    header.indexOffset = 0;
+    staging.assign(header.frameStride, 0);
+
+    // Gros tampon de flux : une frame ne coûte que quelques appels système
+    file.rdbuf()->pubsetbuf(streamBuffer.data(), streamBuffer.size());
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        throw std::runtime_error("HeightfieldWriter: impossible d'ouvrir " + path);
+
+    // En-tête provisoire, réécrit par close()
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+HeightfieldWriter::~HeightfieldWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+    }
+}
+
+void HeightfieldWriter::encodeChannel(const float *values, std::size_t stride, char *out) const
+{
+    const std::size_t count = static_cast<std::size_t>(header.resolution) * header.resolution;
+    if (header.format == HEIGHTFIELD_FLOAT16)
+    {
+        std::uint16_t *half = reinterpret_cast<std::uint16_t *>(out);
+        for (std::size_t i = 0; i < count; ++i)
+            half[i] = floatToHalf(values[i * stride]);
+    }
+    else if (stride == 1)
+    {
+        std::memcpy(out, values, count * sizeof(float));
+    }
+    else
+    {
+        float *full = reinterpret_cast<float *>(out);
+        for (std::size_t i = 0; i < count; ++i)
+            full[i] = values[i * stride];
+    }
+}
+
+void HeightfieldWriter::appendFrame(std::int64_t frame, double time, Span<const float> heights,
+                                    Span<const std::complex<float>> displacements)
+{
+    const std::size_t count = static_cast<std::size_t>(header.resolution) * header.resolution;
+    if (closed)
+        throw std::logic_error("HeightfieldWriter: fichier déjà fermé");
+    if (heights.size() != count || (header.channelCount == 3 && displacements.size() != count))
+        throw std::invalid_argument("HeightfieldWriter: taille de frame incorrecte");
+
+    const std::size_t bytes = channelBytes(header);
+    encodeChannel(heights.data(), 1, staging.data());
+    if (header.channelCount == 3)
+    {
+        // x + iz entrelacés : parties réelles puis imaginaires avec un pas de 2
+        const float *xz = reinterpret_cast<const float *>(displacements.data());
+        encodeChannel(xz, 2, staging.data() + bytes);
+        encodeChannel(xz + 1, 2, staging.data() + 2 * bytes);
+    }
+
+    file.write(staging.data(), staging.size());
+    if (!file)
+        throw std::runtime_error("HeightfieldWriter: échec d'écriture");
+    index.push_back(HeightfieldIndexEntry{frame, time});
+}
+
+void HeightfieldWriter::writeFrame(int frame, Span<float> heights, Span<const std::complex<float>> displacements)
+{
+    appendFrame(frame, static_cast<double>(frame) * header.timeStep, heights, displacements);
+}
+
+void HeightfieldWriter::close()
+{
+    if (closed)
+        return;
+    closed = true;
+
+    header.frameCount = index.size();
+    header.indexOffset = header.dataOffset + header.frameCount * header.frameStride;
+    file.write(reinterpret_cast<const char *>(index.data()), index.size() * sizeof(HeightfieldIndexEntry));
+    file.seekp(0);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.close();
+    if (!file)
+        throw std::runtime_error("HeightfieldWriter: échec de la finalisation du fichier");
+}
+
+HeightfieldReader::HeightfieldReader(const std::string &path)
+    : mapping(nullptr), mappingSize(0), head(nullptr), index(nullptr)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("HeightfieldReader: impossible d'ouvrir " + path);
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(HeightfieldHeader))
+    {
+        ::close(fd);
+        throw std::runtime_error("HeightfieldReader: fichier trop court " + path);
+    }
+
+    mappingSize = info.st_size;
+    void *address = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // La projection reste valide après la fermeture
+    if (address == MAP_FAILED)
+        throw std::runtime_error("HeightfieldReader: échec de mmap sur " + path);
+    mapping = static_cast<const unsigned char *>(address);
+    head = reinterpret_cast<const HeightfieldHeader *>(mapping);
+
+    const bool valid = std::memcmp(head->magic, HEIGHTFIELD_MAGIC, sizeof(head->magic)) == 0 &&
+                       head->version == HEIGHTFIELD_VERSION && isSupportedResolution(head->resolution) &&
+                       (head->channelCount == 1 || head->channelCount == 3) && head->format <= HEIGHTFIELD_FLOAT16 &&
+                       head->frameStride >= head->channelCount * channelBytes(*head) &&
+                       head->indexOffset == head->dataOffset + head->frameCount * head->frameStride &&
+                       head->indexOffset + head->frameCount * sizeof(HeightfieldIndexEntry) <= mappingSize;
+    if (!valid)
+    {
+        munmap(const_cast<unsigned char *>(mapping), mappingSize);
+        throw std::runtime_error("HeightfieldReader: fichier invalide ou incomplet " + path);
+    }
+    index = reinterpret_cast<const HeightfieldIndexEntry *>(mapping + head->indexOffset);
+}
+
+HeightfieldReader::~HeightfieldReader()
+{
+    munmap(const_cast<unsigned char *>(mapping), mappingSize);
+}
+
+const HeightfieldHeader &HeightfieldReader::header() const
+{
+    return *head;
+}
+
+int HeightfieldReader::getResolution() const
+{
+    return head->resolution;
+}
+
+std::size_t HeightfieldReader::frameCount() const
+{
+    return head->frameCount;
+}
+
+const HeightfieldIndexEntry &HeightfieldReader::indexEntry(std::size_t frame) const
+{
+    if (frame >= head->frameCount)
+        throw std::out_of_range("HeightfieldReader: frame hors du fichier");
+    return index[frame];
+}
+
+const unsigned char *HeightfieldReader::channelData(std::size_t frame, HeightfieldChannel channel) const
+{
+    if (frame >= head->frameCount)
+        throw std::out_of_range("HeightfieldReader: frame hors du fichier");
+    if (static_cast<std::uint32_t>(channel) >= head->channelCount)
+        throw std::out_of_range("HeightfieldReader: canal absent du fichier");
+    return mapping + head->dataOffset + frame * head->frameStride + channel * channelBytes(*head);
+}
+
+Span<const float> HeightfieldReader::channel(std::size_t frame, HeightfieldChannel channel) const
+{
+    if (head->format != HEIGHTFIELD_FLOAT32)
+        throw std::logic_error("HeightfieldReader: fichier en float16, utiliser channelHalf ou decode");
+    return Span<const float>(reinterpret_cast<const float *>(channelData(frame, channel)),
+                             static_cast<std::size_t>(head->resolution) * head->resolution);
+}
+
+Span<const std::uint16_t> HeightfieldReader::channelHalf(std::size_t frame, HeightfieldChannel channel) const
+{
+    if (head->format != HEIGHTFIELD_FLOAT16)
+        throw std::logic_error("HeightfieldReader: fichier en float32, utiliser channel");
+    return Span<const std::uint16_t>(reinterpret_cast<const std::uint16_t *>(channelData(frame, channel)),
+                                     static_cast<std::size_t>(head->resolution) * head->resolution);
+}
+
+void HeightfieldReader::decode(std::size_t frame, HeightfieldChannel channel, Span<float> out) const
+{
+    const std::size_t count = static_cast<std::size_t>(head->resolution) * head->resolution;
+    if (out.size() != count)
+        throw std::invalid_argument("HeightfieldReader: tampon de sortie de taille incorrecte");
+
+    if (head->format == HEIGHTFIELD_FLOAT32)
+    {
+        std::memcpy(out.data(), channelData(frame, channel), count * sizeof(float));
+    }
+    else
+    {
+        const std::uint16_t *half = reinterpret_cast<const std::uint16_t *>(channelData(frame, channel));
+        for (std::size_t i = 0; i < count; ++i)
+            out[i] = halfToFloat(half[i]);
+    }
+}
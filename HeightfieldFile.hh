@@ -0,0 +1,131 @@
+#ifndef HEIGHTFIELDFILE_H
+#define HEIGHTFIELDFILE_H
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Span.hh"
+#include "BatchWriter.hh"
+#include "heightmap.hh"
+
+// Conteneur d'animation sur un seul fichier (ordre des octets de la machine) :
+//   [HeightfieldHeader, 256 octets]
+//   [frame 0][frame 1]... à pas fixe frameStride, multiple de 64 octets
+//   [index : un HeightfieldIndexEntry par frame]
+// Chaque frame range ses canaux l'un après l'autre, resolution² valeurs
+// float32 ou float16 chacun : hauteurs, puis déplacements x et z si présents.
+// Les hauteurs sont brutes (non normalisées).
+
+enum HeightfieldFormat : std::uint32_t
+{
+    HEIGHTFIELD_FLOAT32 = 0,
+    HEIGHTFIELD_FLOAT16 = 1
+};
+
+enum HeightfieldChannel
+{
+    HEIGHTFIELD_HEIGHTS = 0,
+    HEIGHTFIELD_DISPLACEMENT_X = 1,
+    HEIGHTFIELD_DISPLACEMENT_Z = 2
+};
+
+struct HeightfieldHeader
+{
+    char magic[8];              // "OCEANHF1"
+    std::uint32_t version;
+    std::uint32_t resolution;
+    std::uint32_t format;       // HeightfieldFormat
+    std::uint32_t channelCount; // 1 (hauteurs) ou 3 (hauteurs + déplacements)
+    std::uint32_t seed;         // Graine du spectre initial
+    std::uint32_t reserved;
+    std::uint64_t frameCount;
+    std::uint64_t frameStride; // Octets entre deux frames
+    std::uint64_t dataOffset;
+    std::uint64_t indexOffset;
+    float patchSize;
+    float timeStep;
+    float windSpeed;
+    float windDirectionX;
+    float windDirectionY;
+    float choppiness;
+    float gravity;
+    float pruneThreshold;      // Part d'énergie du spectre écartée au plus (0 : aucune)
+    std::uint8_t padding[160];
+};
+static_assert(sizeof(HeightfieldHeader) == 256, "HeightfieldHeader: 256 octets attendus");
+
+struct HeightfieldIndexEntry
+{
+    std::int64_t frame; // Numéro de frame dans l'animation complète
+    double time;
+};
+
+// Demi-flottants IEEE 754, arrondi au plus proche
+std::uint16_t floatToHalf(float value);
+float halfToFloat(std::uint16_t value);
+
+// En-tête rempli avec les paramètres de la simulation (par défaut ceux de la compilation)
+HeightfieldHeader makeHeightfieldHeader(int resolution, HeightfieldFormat format, bool withDisplacements,
+                                        unsigned seed, float timeStep, const OceanParameters &parameters = OceanParameters());
+
+// Écriture en flux : les frames sont ajoutées au fil de l'eau, l'index et
+// l'en-tête définitif sont écrits par close().
+// Utilisable directement ou comme sink d'un BatchWriter.
+class HeightfieldWriter : public FrameSink
+{
+private:
+    std::ofstream file;
+    std::vector<char> streamBuffer;
+    HeightfieldHeader header;
+    std::vector<HeightfieldIndexEntry> index;
+    std::vector<char> staging; // Frame encodée avant écriture
+    bool closed;
+
+    void encodeChannel(const float *values, std::size_t stride, char *out) const;
+
+public:
+    HeightfieldWriter(const std::string &path, const HeightfieldHeader &header);
+    ~HeightfieldWriter();
+    HeightfieldWriter(const HeightfieldWriter &) = delete;
+    HeightfieldWriter &operator=(const HeightfieldWriter &) = delete;
+
+    // displacements (x + iz) n'est lu que si le fichier a trois canaux
+    void appendFrame(std::int64_t frame, double time, Span<const float> heights,
+                     Span<const std::complex<float>> displacements = Span<const std::complex<float>>());
+    void writeFrame(int frame, Span<float> heights, Span<const std::complex<float>> displacements) override;
+    void close();
+};
+
+// Lecture par projection mémoire : accès direct à n'importe quelle frame, sans copie
+class HeightfieldReader
+{
+private:
+    const unsigned char *mapping;
+    std::size_t mappingSize;
+    const HeightfieldHeader *head;
+    const HeightfieldIndexEntry *index;
+
+    const unsigned char *channelData(std::size_t frame, HeightfieldChannel channel) const;
+
+public:
+    explicit HeightfieldReader(const std::string &path);
+    ~HeightfieldReader();
+    HeightfieldReader(const HeightfieldReader &) = delete;
+    HeightfieldReader &operator=(const HeightfieldReader &) = delete;
+
+    const HeightfieldHeader &header() const;
+    int getResolution() const;
+    std::size_t frameCount() const;
+    const HeightfieldIndexEntry &indexEntry(std::size_t frame) const;
+
+    // Vues directes sur le fichier, selon le format stocké
+    Span<const float> channel(std::size_t frame, HeightfieldChannel channel) const;
+    Span<const std::uint16_t> channelHalf(std::size_t frame, HeightfieldChannel channel) const;
+    // Copie convertie en float, quel que soit le format
+    void decode(std::size_t frame, HeightfieldChannel channel, Span<float> out) const;
+};
+
+#endif // HEIGHTFIELDFILE_H
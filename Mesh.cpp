@@ -0,0 +1,144 @@
+#include "Mesh.hh"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "SimdKernels.hh"
+#include "ThreadPool.hh"
+
+std::vector<float> convertToVertices(Span<const float> heightmap, std::size_t size)
+{
+    std::vector<float> vertices;
+    for (size_t i = 0; i < size; ++i)
+    {
+        for (size_t j = 0; j < size; ++j)
+        {
+            vertices.push_back(i);                                             // x
+            vertices.push_back(heightmap[i * size + j] * VERTEX_HEIGHT_SCALE); // y (hauteur)
+            vertices.push_back(j);                                             // z
+        }
+    }
+    return vertices;
+}
+
+std::vector<unsigned int> generateIndices(std::size_t width, std::size_t height)
+{
+    std::vector<unsigned int> indices;
+    for (size_t i = 0; i < height - 1; ++i)
+    {
+        for (size_t j = 0; j < width - 1; ++j)
+        {
+            // Triangle 1
+            indices.push_back(i * width + j);
+            indices.push_back((i + 1) * width + j);
+            indices.push_back(i * width + j + 1);
+
+            // Triangle 2
+            indices.push_back((i + 1) * width + j);
+            indices.push_back((i + 1) * width + j + 1);
+            indices.push_back(i * width + j + 1);
+        }
+    }
+    return indices;
+}
+
+VertexBuilder::VertexBuilder(std::size_t size, float cellSize, float choppiness, VertexFormat format)
+    : size(size), cellSize(cellSize), choppiness(choppiness), format(format), rowMin(size), rowMax(size), rangeMin(0), rangeMax(0)
+{
+}
+
+Span<const float> VertexBuilder::build(Span<const float> heights, Span<const std::complex<float>> displacements,
+                                       Span<const std::complex<float>> slopes)
+{
+    // Alloué au premier appel : inutile quand les sommets vont dans un buffer fourni
+    if (vertices.empty())
+        vertices.resize(size * size * format);
+    build(heights, displacements, slopes, Span<float>(vertices.data(), vertices.size()));
+    return getVertices();
+}
+
+void VertexBuilder::build(Span<const float> heights, Span<const std::complex<float>> displacements,
+                          Span<const std::complex<float>> slopes, Span<float> target)
+{
+    if (target.size() != size * size * format)
+        throw std::invalid_argument("VertexBuilder::build: taille du buffer de sommets incorrecte");
+
+    // Première frame (ou surface plate jusqu'ici) : pas de plage utilisable
+    if (!(rangeMax > rangeMin))
+        measureRange(heights);
+
+    const float range = rangeMax - rangeMin;
+    const float scale = range > 0 ? 0.5f / range : 0.0f;
+    const float offset = 0.25f - rangeMin * scale;
+    // Déplacements en mètres -> unités de la grille
+    const float horizontal = choppiness / cellSize;
+    // Pente du sommet rendu : dy/dx = VERTEX_HEIGHT_SCALE * scale * sign(h) * dh/dx * cellSize
+    const float slopeScale = VERTEX_HEIGHT_SCALE * scale * cellSize;
+    const int vertexStride = format;
+    const bool displaced = !displacements.empty() && format != VERTEX_HEIGHT;
+    const bool withNormals = format == VERTEX_POSITION_NORMAL;
+    const bool withSlopes = !slopes.empty();
+    const int rows = static_cast<int>(size);
+
+    ThreadPool &pool = ThreadPool::shared();
+    pool.parallelFor(0, rows, pool.grainFor(rows), [&](int first, int last)
+    {
+        for (int i = first; i < last; ++i)
+        {
+            float low = std::numeric_limits<float>::max();
+            float high = std::numeric_limits<float>::lowest();
+            float *out = target.data() + static_cast<std::size_t>(i) * size * vertexStride;
+            for (std::size_t j = 0; j < size; ++j)
+            {
+                const std::size_t index = i * size + j;
+                const float h = heights[index];
+                const float a = std::abs(h);
+                low = std::min(low, a);
+                high = std::max(high, a);
+
+                const float y = (a * scale + offset) * VERTEX_HEIGHT_SCALE;
+                if (format == VERTEX_HEIGHT)
+                {
+                    out[0] = y;
+                    out += vertexStride;
+                    continue;
+                }
+
+                const std::complex<float> d = displaced ? displacements[index] : std::complex<float>();
+                out[0] = i + horizontal * d.real(); // x
+                out[1] = y;                         // y (hauteur)
+                out[2] = j + horizontal * d.imag(); // z
+                if (withNormals)
+                {
+                    const std::complex<float> s = withSlopes ? slopes[index] : std::complex<float>();
+                    // |h| : la pente change de signe avec h
+                    const float k = h < 0 ? -slopeScale : slopeScale;
+                    const float gx = k * s.real();
+                    const float gz = k * s.imag();
+                    const float inverseLength = 1.0f / std::sqrt(gx * gx + 1.0f + gz * gz);
+                    out[3] = -gx * inverseLength;
+                    out[4] = inverseLength;
+                    out[5] = -gz * inverseLength;
+                }
+                out += vertexStride;
+            }
+            rowMin[i] = low;
+            rowMax[i] = high;
+        }
+    });
+
+    // Plage utilisée par la frame suivante
+    rangeMin = *std::min_element(rowMin.begin(), rowMin.end());
+    rangeMax = *std::max_element(rowMax.begin(), rowMax.end());
+}
+
+void VertexBuilder::measureRange(Span<const float> heights)
+{
+    rangeMin = std::numeric_limits<float>::max();
+    rangeMax = std::numeric_limits<float>::lowest();
+    absMinMaxKernel(heights.data(), heights.size(), rangeMin, rangeMax);
+}
+
+int VertexBuilder::stride() const { return format; }
+VertexFormat VertexBuilder::getFormat() const { return format; }
+Span<const float> VertexBuilder::getVertices() const { return Span<const float>(vertices.data(), vertices.size()); }
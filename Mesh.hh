@@ -0,0 +1,70 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+#include "Span.hh"
+
+// Construction du maillage de la surface à partir de la grille de hauteurs,
+// indépendante d'OpenGL (float et unsigned int correspondent à GLfloat et GLuint).
+
+// Facteur d'échelle des hauteurs normalisées dans les sommets
+constexpr float VERTEX_HEIGHT_SCALE = 20;
+
+// Sommets (x, hauteur * 20, z) de la grille size x size
+std::vector<float> convertToVertices(Span<const float> heightmap, std::size_t size);
+
+// Deux triangles par cellule de la grille width x height
+std::vector<unsigned int> generateIndices(std::size_t width, std::size_t height);
+
+// Contenu d'un sommet écrit par VertexBuilder (la valeur est le nombre de floats)
+enum VertexFormat
+{
+    VERTEX_HEIGHT = 1,          // y seul : x et z sont ceux de la grille
+    VERTEX_POSITION = 3,        // x, y, z (avec déplacement horizontal)
+    VERTEX_POSITION_NORMAL = 6  // x, y, z, nx, ny, nz
+};
+
+// Passe unique de la sortie de l'IFFT vers les sommets entrelacés de la
+// grille size x size, dans un buffer réutilisé d'une frame à l'autre. y est |h| ramené dans [0.25, 0.75] comme par
+// normalizeHeightMap, puis multiplié par VERTEX_HEIGHT_SCALE ; la plage de |h|
+// est celle de la frame précédente, mesurée pendant la passe (la première
+// frame la mesure d'abord, measureRange la fixe à celle d'une frame donnée).
+// Les hauteurs d'entrée ne sont pas modifiées.
+class VertexBuilder
+{
+private:
+    std::size_t size;
+    float cellSize;   // Taille d'une cellule en mètres
+    float choppiness; // Facteur des déplacements horizontaux
+    VertexFormat format;
+    std::vector<float> vertices;
+    std::vector<float> rowMin; // Plage de |h| par ligne, réduite après la passe
+    std::vector<float> rowMax;
+    float rangeMin;
+    float rangeMax;
+
+public:
+    VertexBuilder(std::size_t size, float cellSize, float choppiness, VertexFormat format);
+
+    // displacements (x + iz, en mètres) et slopes (dh/dx + i dh/dz) peuvent être
+    // vides : pas de déplacement horizontal, normales verticales.
+    // VERTEX_HEIGHT ne lit que heights.
+    Span<const float> build(Span<const float> heights, Span<const std::complex<float>> displacements,
+                            Span<const std::complex<float>> slopes);
+    // Même passe, vers target (size * size * stride() floats) au lieu du buffer interne
+    void build(Span<const float> heights, Span<const std::complex<float>> displacements,
+               Span<const std::complex<float>> slopes, Span<float> target);
+
+    // Plage de |h| de heights pour le build suivant, au lieu de celle de la
+    // frame précédente : des frames rendues séparément sont alors normalisées
+    // comme dans une seule séquence. Ne lit que les hauteurs.
+    void measureRange(Span<const float> heights);
+
+    int stride() const; // Floats par sommet
+    VertexFormat getFormat() const;
+    Span<const float> getVertices() const;
+};
+
+#endif // MESH_H
@@ -0,0 +1,265 @@
+#include "MeshTopology.hh"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+MeshTopology::MeshTopology(int size, TopologyLayout layout)
+    : size(size), layout(layout), bandWidth(0), wide(false)
+{
+    if (size < 2)
+        throw std::invalid_argument("MeshTopology: au moins 2 x 2 sommets attendus");
+
+    const std::uint32_t n = size;
+    const std::size_t vertexCount = static_cast<std::size_t>(size) * size;
+    // En 16 bits, 0xFFFF reste libre pour l'index de redémarrage
+    wide = vertexCount >= 0xFFFF;
+    const std::size_t rows = size - 1;
+    const std::size_t count = layout == TOPOLOGY_STRIPS ? rows * (2 * size + 1) : 6 * rows * rows;
+    if (wide)
+        indices32.reserve(count);
+    else
+        indices16.reserve(count);
+
+    // Deux triangles par cellule (i, j), même sens de parcours que generateIndices
+    auto appendCell = [&](std::uint32_t i, std::uint32_t j)
+    {
+        append(i * n + j);
+        append((i + 1) * n + j);
+        append(i * n + j + 1);
+
+        append((i + 1) * n + j);
+        append((i + 1) * n + j + 1);
+        append(i * n + j + 1);
+    };
+
+    switch (layout)
+    {
+    case TOPOLOGY_ROWS:
+        for (std::uint32_t i = 0; i + 1 < n; ++i)
+            for (std::uint32_t j = 0; j + 1 < n; ++j)
+                appendCell(i, j);
+        break;
+
+    case TOPOLOGY_STRIPS:
+        for (std::uint32_t i = 0; i + 1 < n; ++i)
+        {
+            for (std::uint32_t j = 0; j < n; ++j)
+            {
+                append(i * n + j);
+                append((i + 1) * n + j);
+            }
+            append(restartIndex());
+        }
+        break;
+
+    case TOPOLOGY_BANDS:
+        // Une bande de bandWidth cellules est parcourue ligne par ligne : la
+        // ligne de sommets du bas d'une rangée est encore dans le cache quand
+        // elle sert de haut à la suivante (environ 0.5 + 1 / (2 bandWidth)
+        // sommet par triangle au lieu de 1). Avec un FIFO, les deux lignes de
+        // bandWidth + 1 sommets doivent tenir ensemble dans le cache.
+        bandWidth = DEFAULT_CACHE_SIZE / 2 - 1;
+        for (std::uint32_t j0 = 0; j0 + 1 < n; j0 += bandWidth)
+        {
+            const std::uint32_t j1 = std::min<std::uint32_t>(j0 + bandWidth, n - 1);
+            for (std::uint32_t i = 0; i + 1 < n; ++i)
+                for (std::uint32_t j = j0; j < j1; ++j)
+                    appendCell(i, j);
+        }
+        break;
+    }
+}
+
+void MeshTopology::append(std::uint32_t index)
+{
+    if (wide)
+        indices32.push_back(index);
+    else
+        indices16.push_back(static_cast<std::uint16_t>(index));
+}
+
+int MeshTopology::getSize() const { return size; }
+TopologyLayout MeshTopology::getLayout() const { return layout; }
+int MeshTopology::getBandWidth() const { return bandWidth; }
+bool MeshTopology::isStrip() const { return layout == TOPOLOGY_STRIPS; }
+std::size_t MeshTopology::indexCount() const { return wide ? indices32.size() : indices16.size(); }
+std::size_t MeshTopology::indexSize() const { return wide ? sizeof(std::uint32_t) : sizeof(std::uint16_t); }
+const void *MeshTopology::data() const { return wide ? static_cast<const void *>(indices32.data()) : indices16.data(); }
+std::uint32_t MeshTopology::index(std::size_t i) const { return wide ? indices32[i] : indices16[i]; }
+std::uint32_t MeshTopology::restartIndex() const { return wide ? 0xFFFFFFFFu : 0xFFFFu; }
+
+std::size_t MeshTopology::triangleCount() const
+{
+    return 2 * static_cast<std::size_t>(size - 1) * (size - 1);
+}
+
+const MeshTopology &MeshTopology::get(int size, TopologyLayout layout)
+{
+    static std::map<std::pair<int, int>, std::unique_ptr<MeshTopology>> topologies;
+    static std::mutex mutex;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<MeshTopology> &topology = topologies[std::make_pair(size, static_cast<int>(layout))];
+    if (!topology)
+        topology.reset(new MeshTopology(size, layout));
+    return *topology;
+}
+
+const char *MeshTopology::layoutName(TopologyLayout layout)
+{
+    switch (layout)
+    {
+    case TOPOLOGY_ROWS:
+        return "rows";
+    case TOPOLOGY_STRIPS:
+        return "strips";
+    case TOPOLOGY_BANDS:
+        return "bands";
+    }
+    return "unknown";
+}
+
+TileTopology::TileTopology(int size, int levelCount)
+    : size(size), levelCount(levelCount), wide(false)
+{
+    if (size < 1 || (size & (size - 1)) != 0)
+        throw std::invalid_argument("TileTopology: taille de tuile en puissance de deux attendue");
+    if (levelCount < 1 || levelCount > maxLevelCount(size))
+        throw std::invalid_argument("TileTopology: nombre de niveaux de détail invalide");
+
+    const std::uint32_t n = size + 1;
+    wide = vertexCount() >= 0xFFFF;
+
+    for (int lod = 0; lod < levelCount; ++lod)
+    {
+        const int step = 1 << lod;
+        const int cells = size >> lod;
+
+        // Sommet (a, b) du niveau, ramené sur le sommet pair précédent le long des côtés cousus
+        auto vertex = [&](int a, int b, unsigned stitch) -> std::uint32_t
+        {
+            if (((a == 0 && (stitch & SIDE_X_MIN)) || (a == cells && (stitch & SIDE_X_MAX))) && (b & 1))
+                --b;
+            if (((b == 0 && (stitch & SIDE_Z_MIN)) || (b == cells && (stitch & SIDE_Z_MAX))) && (a & 1))
+                --a;
+            return static_cast<std::uint32_t>(a * step) * n + static_cast<std::uint32_t>(b * step);
+        };
+        // Deux triangles par cellule, même sens de parcours que MeshTopology
+        auto appendCell = [&](int a, int b, unsigned stitch)
+        {
+            append(vertex(a, b, stitch));
+            append(vertex(a + 1, b, stitch));
+            append(vertex(a, b + 1, stitch));
+
+            append(vertex(a + 1, b, stitch));
+            append(vertex(a + 1, b + 1, stitch));
+            append(vertex(a, b + 1, stitch));
+        };
+
+        Range range = {indexCount(), 0};
+        const int bandWidth = MeshTopology::DEFAULT_CACHE_SIZE / 2 - 1;
+        for (int b0 = 1; b0 < cells - 1; b0 += bandWidth)
+        {
+            const int b1 = std::min(b0 + bandWidth, cells - 1);
+            for (int a = 1; a < cells - 1; ++a)
+                for (int b = b0; b < b1; ++b)
+                    appendCell(a, b, 0);
+        }
+        range.count = indexCount() - range.first;
+        ranges.push_back(range);
+
+        for (unsigned stitch = 0; stitch < STITCH_COUNT; ++stitch)
+        {
+            range.first = indexCount();
+            for (int a = 0; a < cells; ++a)
+            {
+                for (int b = 0; b < cells; ++b)
+                {
+                    if (a == 0 || b == 0 || a == cells - 1 || b == cells - 1)
+                        appendCell(a, b, stitch);
+                }
+            }
+            range.count = indexCount() - range.first;
+            ranges.push_back(range);
+        }
+    }
+}
+
+void TileTopology::append(std::uint32_t index)
+{
+    if (wide)
+        indices32.push_back(index);
+    else
+        indices16.push_back(static_cast<std::uint16_t>(index));
+}
+
+int TileTopology::getSize() const { return size; }
+int TileTopology::getLevelCount() const { return levelCount; }
+std::size_t TileTopology::vertexCount() const { return static_cast<std::size_t>(size + 1) * (size + 1); }
+std::size_t TileTopology::indexCount() const { return wide ? indices32.size() : indices16.size(); }
+std::size_t TileTopology::indexSize() const { return wide ? sizeof(std::uint32_t) : sizeof(std::uint16_t); }
+const void *TileTopology::data() const { return wide ? static_cast<const void *>(indices32.data()) : indices16.data(); }
+std::uint32_t TileTopology::index(std::size_t i) const { return wide ? indices32[i] : indices16[i]; }
+
+TileTopology::Range TileTopology::interior(int lod) const
+{
+    return ranges[lod * (STITCH_COUNT + 1)];
+}
+
+TileTopology::Range TileTopology::border(int lod, unsigned stitch) const
+{
+    return ranges[lod * (STITCH_COUNT + 1) + 1 + (stitch & (STITCH_COUNT - 1))];
+}
+
+std::size_t TileTopology::triangleCount(int lod) const
+{
+    const std::size_t cells = size >> lod;
+    return 2 * cells * cells;
+}
+
+int TileTopology::maxLevelCount(int size)
+{
+    int levels = 1;
+    while ((size >> levels) >= 1)
+        ++levels;
+    return levels;
+}
+
+const TileTopology &TileTopology::get(int size, int levelCount)
+{
+    static std::map<std::pair<int, int>, std::unique_ptr<TileTopology>> topologies;
+    static std::mutex mutex;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<TileTopology> &topology = topologies[std::make_pair(size, levelCount)];
+    if (!topology)
+        topology.reset(new TileTopology(size, levelCount));
+    return *topology;
+}
+
+double simulateACMR(const MeshTopology &topology, int cacheSize)
+{
+    // FIFO : un sommet absent entre dans le cache et en chasse le plus ancien ;
+    // un succès ne change pas l'ordre
+    const std::size_t vertexCount = static_cast<std::size_t>(topology.getSize()) * topology.getSize();
+    std::vector<long long> insertedAt(vertexCount, -1); // Date d'entrée dans le cache
+    long long insertions = 0;
+    std::size_t misses = 0;
+    const std::uint32_t restart = topology.restartIndex();
+
+    for (std::size_t i = 0; i < topology.indexCount(); ++i)
+    {
+        const std::uint32_t index = topology.index(i);
+        if (topology.isStrip() && index == restart)
+            continue;
+        if (insertedAt[index] < 0 || insertions - insertedAt[index] > cacheSize)
+        {
+            insertedAt[index] = insertions++;
+            ++misses;
+        }
+    }
+    return static_cast<double>(misses) / topology.triangleCount();
+}
@@ -0,0 +1,115 @@
+#ifndef MESHTOPOLOGY_H
+#define MESHTOPOLOGY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Indices de la grille size x size, calculés une fois par résolution et par
+// disposition puis partagés (la topologie ne change jamais d'une frame à l'autre).
+// Indices 16 bits tant que la grille le permet, 32 bits sinon.
+
+enum TopologyLayout
+{
+    TOPOLOGY_ROWS,   // Liste de triangles ligne par ligne (ordre de generateIndices)
+    TOPOLOGY_STRIPS, // Une bande de triangles par ligne, séparées par l'index de redémarrage
+    TOPOLOGY_BANDS   // Liste de triangles par bandes verticales, pour le cache de sommets
+};
+
+class MeshTopology
+{
+private:
+    int size;
+    TopologyLayout layout;
+    int bandWidth; // Cellules par bande (TOPOLOGY_BANDS)
+    bool wide;     // Indices 32 bits
+    std::vector<std::uint16_t> indices16;
+    std::vector<std::uint32_t> indices32;
+
+    void append(std::uint32_t index);
+
+public:
+    // Cache FIFO visé par TOPOLOGY_BANDS (taille courante des GPU récents)
+    static const int DEFAULT_CACHE_SIZE = 32;
+
+    MeshTopology(int size, TopologyLayout layout);
+
+    int getSize() const;
+    TopologyLayout getLayout() const;
+    int getBandWidth() const;
+    bool isStrip() const;                   // Vrai pour TOPOLOGY_STRIPS (avec redémarrage)
+    std::size_t indexCount() const;         // Index de redémarrage compris
+    std::size_t indexSize() const;          // 2 ou 4 octets
+    const void *data() const;
+    std::uint32_t index(std::size_t i) const;
+    std::uint32_t restartIndex() const;     // 0xFFFF ou 0xFFFFFFFF selon indexSize()
+    std::size_t triangleCount() const;
+
+    static const MeshTopology &get(int size, TopologyLayout layout); // Topologie partagée
+    static const char *layoutName(TopologyLayout layout);
+};
+
+// Côtés d'une tuile dont la voisine est d'un niveau de détail plus grossier
+enum TileSide
+{
+    SIDE_X_MIN = 1, // i = 0
+    SIDE_X_MAX = 2, // i = size
+    SIDE_Z_MIN = 4, // j = 0
+    SIDE_Z_MAX = 8  // j = size
+};
+
+// Indices des niveaux de détail d'une tuile de size x size cellules, sur la
+// grille (size + 1)² dont la dernière ligne et la dernière colonne répètent la
+// première (le champ de hauteurs est périodique). Le niveau lod ne garde qu'un
+// sommet sur 2^lod. Chaque niveau est découpé en un intérieur (par bandes,
+// comme TOPOLOGY_BANDS) et une bordure d'une cellule déclinée pour les 16
+// combinaisons de côtés voisins d'un niveau plus grossier : sur ces côtés, les
+// sommets impairs sont ramenés sur le sommet pair précédent, ce qui supprime
+// les fissures tant que deux tuiles voisines diffèrent d'au plus un niveau.
+class TileTopology
+{
+public:
+    struct Range
+    {
+        std::size_t first; // Premier index
+        std::size_t count;
+    };
+
+private:
+    int size;
+    int levelCount;
+    bool wide; // Indices 32 bits
+    std::vector<std::uint16_t> indices16;
+    std::vector<std::uint32_t> indices32;
+    std::vector<Range> ranges; // Par niveau : intérieur puis les 16 bordures
+
+    void append(std::uint32_t index);
+
+public:
+    static const int STITCH_COUNT = 16;
+
+    // size : puissance de deux ; levelCount niveaux, jusqu'à une cellule par tuile
+    TileTopology(int size, int levelCount);
+
+    int getSize() const;
+    int getLevelCount() const;
+    std::size_t vertexCount() const; // (size + 1)²
+    std::size_t indexCount() const;
+    std::size_t indexSize() const;   // 2 ou 4 octets
+    const void *data() const;
+    std::uint32_t index(std::size_t i) const;
+
+    Range interior(int lod) const;
+    Range border(int lod, unsigned stitch) const; // stitch : combinaison de TileSide
+    std::size_t triangleCount(int lod) const;     // Triangles dessinés par une tuile, dégénérés compris
+
+    static int maxLevelCount(int size);
+    static const TileTopology &get(int size, int levelCount); // Topologie partagée
+};
+
+// Simulation d'un cache de sommets FIFO de cacheSize entrées sur le flux
+// d'indices : nombre moyen de sommets transformés par triangle (ACMR).
+// 0.5 est la borne basse pour une grille, 3 l'absence totale de réutilisation.
+double simulateACMR(const MeshTopology &topology, int cacheSize = MeshTopology::DEFAULT_CACHE_SIZE);
+
+#endif // MESHTOPOLOGY_H
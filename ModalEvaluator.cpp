@@ -0,0 +1,186 @@
+#include "ModalEvaluator.hh"
+#include "OceanSampler.hh"
+#include "ThreadPool.hh"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace
+{
+    // Points par bloc de parallelFor : chaque point coûte modeCount ondes
+    const int MODAL_BLOCK = 64;
+    // Points mesurés pour estimer le coût par point de chaque chemin
+    const std::size_t CALIBRATION_POINTS = 1024;
+
+    double elapsedNs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+ModalEvaluator::ModalEvaluator(const OceanStateF &state, std::size_t modeCount)
+    : size(state.getResolution()), patchSize(state.getPatchSize()), choppiness(state.getChoppiness()), modeCount(0), energyRetained(0), source(state), gridTime(0),
+      gridValid(false), breakEven(0), lastUsedGrid(false)
+{
+    const std::size_t cells = state.cellCount();
+    Span<const std::complex<float>> spectrum0 = state.spectrum0();
+
+    // Modes triés par énergie |h0|² décroissante, les modes nuls (k = 0) écartés
+    std::vector<float> energies(cells);
+    double totalEnergy = 0;
+    for (std::size_t i = 0; i < cells; ++i)
+    {
+        energies[i] = std::norm(spectrum0[i]);
+        totalEnergy += energies[i];
+    }
+    std::vector<std::size_t> order(cells);
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    const std::size_t nonZero = static_cast<std::size_t>(std::count_if(energies.begin(), energies.end(), [](float e) { return e > 0; }));
+    this->modeCount = std::min(modeCount, nonZero);
+    std::partial_sort(order.begin(), order.begin() + this->modeCount, order.end(),
+                      [&](std::size_t a, std::size_t b) { return energies[a] > energies[b]; });
+
+    const std::size_t padded = (this->modeCount + 7) & ~static_cast<std::size_t>(7);
+    waveX.assign(padded, 0.0f);
+    waveZ.assign(padded, 0.0f);
+    angularSpeeds.assign(padded, 0.0);
+    phases.assign(padded, 0.0f);
+    amplitudeRe.assign(padded, 0.0f);
+    amplitudeIm.assign(padded, 0.0f);
+    directionX.assign(padded, 0.0f);
+    directionZ.assign(padded, 0.0f);
+
+    // Cellule (i, j) : k = π / patchSize (N - 2i, N - 2j) (voir generateSpectra),
+    // et la phase w t - k.x s'écrit 2π (i - N / 2) u + 2π (j - N / 2) v + w t en fraction du domaine
+    const float amplitudeScale = 2.0f / (static_cast<float>(size) * size);
+    double retained = 0;
+    for (std::size_t m = 0; m < this->modeCount; ++m)
+    {
+        const std::size_t index = order[m];
+        const int i = static_cast<int>(index / size);
+        const int j = static_cast<int>(index % size);
+        waveX[m] = static_cast<float>(M_PI * (2 * i - size));
+        waveZ[m] = static_cast<float>(M_PI * (2 * j - size));
+        angularSpeeds[m] = state.angularSpeeds()[index];
+        amplitudeRe[m] = amplitudeScale * spectrum0[index].real();
+        amplitudeIm[m] = amplitudeScale * spectrum0[index].imag();
+        directionX[m] = choppiness * state.directions()[index].real();
+        directionZ[m] = choppiness * state.directions()[index].imag();
+        retained += energies[index];
+    }
+    energyRetained = totalEnergy > 0 ? retained / totalEnergy : 0.0;
+}
+
+ModeSetF ModalEvaluator::modeSet(float t)
+{
+    // w t réduit en double : les phases restent exactes pour t grand
+    const double twoPi = 2 * M_PI;
+    for (std::size_t m = 0; m < phases.size(); ++m)
+    {
+        const double wt = angularSpeeds[m] * t;
+        phases[m] = static_cast<float>(wt - twoPi * std::floor(wt / twoPi));
+    }
+    return ModeSetF{waveX.data(), waveZ.data(), phases.data(), amplitudeRe.data(), amplitudeIm.data(),
+                    directionX.data(), directionZ.data(), phases.size(), 1.0f / patchSize};
+}
+
+void ModalEvaluator::evaluateModes(float t, Span<const float> x, Span<const float> z, Span<float> heights, Span<float> displacementX,
+                                   Span<float> displacementZ)
+{
+    const ModeSetF modes = modeSet(t);
+    const std::size_t count = x.size();
+    const bool displacementsOut = !displacementX.empty();
+    const int blocks = static_cast<int>((count + MODAL_BLOCK - 1) / MODAL_BLOCK);
+    ThreadPool &pool = ThreadPool::shared();
+    pool.parallelFor(0, blocks, pool.grainFor(blocks), [&](int first, int last)
+    {
+        const std::size_t begin = static_cast<std::size_t>(first) * MODAL_BLOCK;
+        const std::size_t end = std::min(count, static_cast<std::size_t>(last) * MODAL_BLOCK);
+        evaluateModesKernel(modes, end - begin, x.data() + begin, z.data() + begin, heights.data() + begin,
+                            displacementsOut ? displacementX.data() + begin : nullptr,
+                            displacementsOut ? displacementZ.data() + begin : nullptr);
+    });
+}
+
+void ModalEvaluator::updateGrid(float t)
+{
+    if (!grid)
+    {
+        grid.reset(new OceanStateF(size));
+        grid->copySpectrumFrom(source);
+    }
+    if (!gridValid || gridTime != t)
+    {
+        UpdateHeights(t, *grid);
+        gridTime = t;
+        gridValid = true;
+    }
+}
+
+void ModalEvaluator::evaluateGrid(float t, Span<const float> x, Span<const float> z, Span<float> heights, Span<float> displacementX,
+                                  Span<float> displacementZ)
+{
+    updateGrid(t);
+    OceanSampler(*grid).sample(x, z, heights, SAMPLE_BICUBIC, 0, displacementX, displacementZ);
+}
+
+void ModalEvaluator::calibrate(float t, Span<const float> x, Span<const float> z)
+{
+    typedef std::chrono::steady_clock Clock;
+    const std::size_t count = std::min(x.size(), CALIBRATION_POINTS);
+    const Span<const float> sampleX(x.data(), count);
+    const Span<const float> sampleZ(z.data(), count);
+    std::vector<float> heights(count);
+    const Span<float> out(heights.data(), count);
+
+    // L'IFFT mesurée ici sert aussi au premier appel sur la grille (même t)
+    Clock::time_point start = Clock::now();
+    gridValid = false;
+    updateGrid(t);
+    const double fftNs = elapsedNs(start);
+
+    start = Clock::now();
+    evaluateGrid(t, sampleX, sampleZ, out, Span<float>(), Span<float>());
+    const double gridPointNs = elapsedNs(start) / count;
+
+    start = Clock::now();
+    evaluateModes(t, sampleX, sampleZ, out, Span<float>(), Span<float>());
+    const double modalPointNs = elapsedNs(start) / count;
+
+    breakEven = modalPointNs > gridPointNs ? static_cast<std::size_t>(std::ceil(fftNs / (modalPointNs - gridPointNs)))
+                                           : std::numeric_limits<std::size_t>::max();
+    breakEven = std::max<std::size_t>(breakEven, 1);
+}
+
+void ModalEvaluator::evaluate(float t, Span<const float> x, Span<const float> z, Span<float> heights, Span<float> displacementX,
+                              Span<float> displacementZ)
+{
+    const std::size_t count = x.size();
+    const bool displacementsOut = !displacementX.empty() || !displacementZ.empty();
+    if (z.size() != count || heights.size() != count ||
+        (displacementsOut && (displacementX.size() != count || displacementZ.size() != count)))
+        throw std::invalid_argument("ModalEvaluator::evaluate: tailles incohérentes");
+
+    // En deçà de N² ondes-points, la somme directe coûte toujours moins qu'une IFFT de N² cellules
+    if (breakEven == 0 && count * modeCount >= source.cellCount())
+        calibrate(t, x, z);
+
+    lastUsedGrid = breakEven != 0 && count >= breakEven;
+    if (lastUsedGrid)
+        evaluateGrid(t, x, z, heights, displacementX, displacementZ);
+    else
+        evaluateModes(t, x, z, heights, displacementX, displacementZ);
+}
+
+std::size_t ModalEvaluator::getModeCount() const { return modeCount; }
+
+double ModalEvaluator::getEnergyRetained() const { return energyRetained; }
+
+std::size_t ModalEvaluator::getBreakEven() const { return breakEven; }
+
+void ModalEvaluator::setBreakEven(std::size_t pointCount) { breakEven = pointCount; }
+
+bool ModalEvaluator::usedGrid() const { return lastUsedGrid; }
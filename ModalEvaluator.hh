@@ -0,0 +1,77 @@
+#ifndef MODALEVALUATOR_H
+#define MODALEVALUATOR_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "OceanState.hh"
+#include "SimdKernels.hh"
+#include "Span.hh"
+#include "heightmap.hh"
+
+// Évaluation exacte de la surface en quelques points (bouée, physique d'un
+// navire à 1 kHz...) sans IFFT complète. Les cellules k et -k du spectre se
+// regroupent en une onde progressive par cellule :
+//     h(x, t) = Σ 2 / N² Re[h0(k) exp(i (w t - k.x))]
+// On ne garde que les modeCount ondes les plus énergétiques (|h0|²), sommées
+// directement : le coût par point ne dépend que de modeCount, pas de la
+// résolution de la grille.
+//
+// Au-delà d'un nombre de points (breakEven), une IFFT complète de tous les modes
+// suivie d'un échantillonnage bicubique (OceanSampler) coûte moins cher :
+// evaluate bascule alors sur ce chemin. Le seuil est mesuré la première fois
+// qu'il peut être atteint, ou fixé par setBreakEven.
+class ModalEvaluator
+{
+private:
+    int size;
+    float patchSize;
+    float choppiness;
+    std::size_t modeCount;
+    double energyRetained;
+
+    // Modes retenus, complétés par des modes nuls jusqu'à un multiple de 8
+    std::vector<float> waveX;
+    std::vector<float> waveZ;
+    std::vector<double> angularSpeeds;
+    std::vector<float> phases; // w t de l'appel en cours
+    std::vector<float> amplitudeRe;
+    std::vector<float> amplitudeIm;
+    std::vector<float> directionX;
+    std::vector<float> directionZ;
+
+    // Chemin IFFT, alloué à la première utilisation
+    const OceanStateF &source;
+    std::unique_ptr<OceanStateF> grid;
+    float gridTime;
+    bool gridValid;
+    std::size_t breakEven; // 0 : pas encore mesuré
+    bool lastUsedGrid;
+
+    ModeSetF modeSet(float t);
+    void updateGrid(float t);
+    void evaluateModes(float t, Span<const float> x, Span<const float> z, Span<float> heights, Span<float> displacementX,
+                       Span<float> displacementZ);
+    void evaluateGrid(float t, Span<const float> x, Span<const float> z, Span<float> heights, Span<float> displacementX,
+                      Span<float> displacementZ);
+    void calibrate(float t, Span<const float> x, Span<const float> z);
+
+public:
+    // state doit contenir un spectre (GenerateSpectra) et survivre à l'objet ;
+    // le domaine et la choppiness sont ceux de state, qui peut être une cascade
+    // (OceanCascades::cascade). modeCount est ramené au nombre de modes non nuls
+    ModalEvaluator(const OceanStateF &state, std::size_t modeCount);
+
+    // Hauteurs (et déplacements choppiness D, optionnels) aux points (x, z) en
+    // mètres à l'instant t
+    void evaluate(float t, Span<const float> x, Span<const float> z, Span<float> heights,
+                  Span<float> displacementX = Span<float>(), Span<float> displacementZ = Span<float>());
+
+    std::size_t getModeCount() const;
+    double getEnergyRetained() const; // Part de Σ |h0|² portée par les modes retenus
+    std::size_t getBreakEven() const; // 0 tant qu'il n'a pas été mesuré
+    void setBreakEven(std::size_t pointCount);
+    bool usedGrid() const; // Chemin pris par le dernier evaluate
+};
+
+#endif // MODALEVALUATOR_H
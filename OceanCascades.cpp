@@ -0,0 +1,174 @@
+#include "OceanCascades.hh"
+#include "Profiler.hh"
+#include "ThreadPool.hh"
+#include <cmath>
+#include <stdexcept>
+
+OceanCascades::OceanCascades(int resolution, int count)
+    : OceanCascades(resolution, defaultBands(resolution, count))
+{
+}
+
+OceanCascades::OceanCascades(int resolution, const std::vector<SpectrumBand> &cascadeBands)
+    : resolution(resolution), bands(cascadeBands)
+{
+    const int count = static_cast<int>(bands.size());
+    if (count < 1 || count > MAX_CASCADES)
+        throw std::invalid_argument("OceanCascades: de 1 à MAX_CASCADES cascades attendues");
+
+    for (int c = 0; c < count; ++c)
+    {
+        // Rapport de taille entier et puissance de deux : la grille de la cascade c
+        // contient exactement les points de la grille 0
+        const double ratio = bands[0].patchSize / bands[c].patchSize;
+        const int stride = static_cast<int>(std::lround(ratio));
+        if (stride < 1 || (stride & (stride - 1)) != 0 || std::fabs(ratio - stride) > 1e-6 * ratio)
+            throw std::invalid_argument("OceanCascades: les tailles de domaine doivent décroître par puissances de deux");
+        strides.push_back(stride);
+        states.emplace_back(new OceanStateF(resolution));
+        pointers.push_back(states.back().get());
+    }
+
+    if (count > 1)
+    {
+        const std::size_t cells = states[0]->cellCount();
+        combinedHeights.resize(cells);
+        combinedDisplacements.resize(cells);
+        combinedSlopes.resize(cells);
+        combinedJacobian.resize(cells);
+    }
+}
+
+std::vector<SpectrumBand> OceanCascades::defaultBands(int resolution, int count)
+{
+    if (count < 1 || count > MAX_CASCADES)
+        throw std::invalid_argument("OceanCascades: de 1 à MAX_CASCADES cascades attendues");
+
+    std::vector<SpectrumBand> result(count);
+    for (int c = 0; c < count; ++c)
+    {
+        result[c].patchSize = PATCH_SIZE * static_cast<float>(1 << (2 * (count - 1 - c)));
+        // Nyquist de la cascade c : π resolution / patchSize
+        if (c + 1 < count)
+            result[c].maxWaveNumber = static_cast<float>(M_PI * resolution / result[c].patchSize);
+        if (c > 0)
+            result[c].minWaveNumber = result[c - 1].maxWaveNumber;
+    }
+    return result;
+}
+
+void OceanCascades::generate(unsigned seed, const OceanParameters &parameters)
+{
+    for (std::size_t c = 0; c < states.size(); ++c)
+        GenerateSpectra(*states[c], seed + static_cast<unsigned>(c), bands[c], parameters);
+}
+
+void OceanCascades::setupPhaseRotors(float t0, float dt, int resyncInterval)
+{
+    for (OceanStateF *state : pointers)
+        SetupPhaseRotors(*state, t0, dt, resyncInterval);
+}
+
+void OceanCascades::update(float t)
+{
+    UpdateHeights(t, Span<OceanStateF *const>(pointers.data(), pointers.size()));
+    combine();
+}
+
+void OceanCascades::step()
+{
+    StepHeights(Span<OceanStateF *const>(pointers.data(), pointers.size()));
+    combine();
+}
+
+void OceanCascades::combine()
+{
+    const int count = getCascadeCount();
+    if (count == 1)
+        return;
+
+    OCEAN_PROFILE_SCOPE_BYTES(STAGE_CASCADES, (4 * sizeof(std::complex<float>) * count + 6 * sizeof(float)) * states[0]->cellCount());
+    const int mask = resolution - 1;
+    const float lambda = states[0]->getChoppiness();
+    const float *heights[MAX_CASCADES];
+    const std::complex<float> *spectra[MAX_CASCADES]; // h + i dDx/dz après l'IFFT
+    const std::complex<float> *displacements[MAX_CASCADES];
+    const std::complex<float> *slopes[MAX_CASCADES];
+    const std::complex<float> *stretches[MAX_CASCADES]; // dDx/dx + i dDz/dz
+    for (int c = 0; c < count; ++c)
+    {
+        heights[c] = pointers[c]->heights().data();
+        spectra[c] = pointers[c]->spectrum().data();
+        displacements[c] = pointers[c]->displacements().data();
+        slopes[c] = pointers[c]->slopes().data();
+        stretches[c] = pointers[c]->jacobianSpectrum().data();
+    }
+    ThreadPool &pool = ThreadPool::shared();
+    pool.parallelFor(0, resolution, pool.grainFor(resolution), [&](int first, int last)
+    {
+        for (int i = first; i < last; ++i)
+        {
+            for (int j = 0; j < resolution; ++j)
+            {
+                float height = 0;
+                float shear = 0;
+                std::complex<float> displacement, slope, stretch;
+                for (int c = 0; c < count; ++c)
+                {
+                    const std::size_t index = static_cast<std::size_t>((i * strides[c]) & mask) * resolution + ((j * strides[c]) & mask);
+                    height += heights[c][index];
+                    shear += spectra[c][index].imag();
+                    displacement += displacements[c][index];
+                    slope += slopes[c][index];
+                    stretch += stretches[c][index];
+                }
+                const std::size_t out = static_cast<std::size_t>(i) * resolution + j;
+                combinedHeights[out] = height;
+                combinedDisplacements[out] = displacement;
+                combinedSlopes[out] = slope;
+                // Jacobien de la somme, à partir des dérivées sommées (voir finishHeights)
+                combinedJacobian[out] = (1 + lambda * stretch.real()) * (1 + lambda * stretch.imag()) - lambda * lambda * shear * shear;
+            }
+        }
+    });
+}
+
+int OceanCascades::getResolution() const { return resolution; }
+
+int OceanCascades::getCascadeCount() const { return static_cast<int>(states.size()); }
+
+float OceanCascades::getPatchSize() const { return bands[0].patchSize; }
+
+const SpectrumBand &OceanCascades::band(int cascade) const { return bands.at(cascade); }
+
+OceanStateF &OceanCascades::cascade(int cascade) { return *states.at(cascade); }
+
+const OceanStateF &OceanCascades::cascade(int cascade) const { return *states.at(cascade); }
+
+Span<const float> OceanCascades::heights() const
+{
+    if (states.size() == 1)
+        return states[0]->heights();
+    return Span<const float>(combinedHeights.data(), combinedHeights.size());
+}
+
+Span<const std::complex<float>> OceanCascades::displacements() const
+{
+    if (states.size() == 1)
+        return states[0]->displacements();
+    return Span<const std::complex<float>>(combinedDisplacements.data(), combinedDisplacements.size());
+}
+
+Span<const std::complex<float>> OceanCascades::slopes() const
+{
+    if (states.size() == 1)
+        return states[0]->slopes();
+    return Span<const std::complex<float>>(combinedSlopes.data(), combinedSlopes.size());
+}
+
+Span<const float> OceanCascades::jacobian() const
+{
+    if (states.size() == 1)
+        return states[0]->jacobian();
+    return Span<const float>(combinedJacobian.data(), combinedJacobian.size());
+}
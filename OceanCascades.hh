@@ -0,0 +1,74 @@
+#ifndef OCEANCASCADES_H
+#define OCEANCASCADES_H
+
+#include <complex>
+#include <memory>
+#include <vector>
+#include "OceanState.hh"
+#include "Span.hh"
+#include "heightmap.hh"
+
+// Simulation en cascades : count domaines de même résolution, du plus grand
+// (cascade 0, houle longue, période de répétition de la surface) au plus
+// petit, chacun d'un quart du précédent. Chaque cascade ne tire que sa bande
+// de nombres d'onde, qui s'arrête là où commence celle de la suivante, à la
+// fréquence de Nyquist de la plus grande : les bandes ne se recouvrent pas et
+// la surface est leur somme. La plus petite cascade est le domaine PATCH_SIZE
+// d'origine ; avec une seule cascade, la simulation est identique à celle
+// d'un OceanStateF.
+//
+// update et step évoluent toutes les cascades en une passe et les transforment
+// par une seule IFFT groupée (4 champs par cascade) : le coût est linéaire en
+// count, sans synchronisation supplémentaire par cascade. La surface combinée
+// est ensuite échantillonnée sur la grille de la cascade 0, les tailles étant
+// dans des rapports entiers : le point i de la grille 0 est le point
+// i * 4^c (mod resolution) de la cascade c.
+class OceanCascades
+{
+private:
+    int resolution;
+    std::vector<SpectrumBand> bands;
+    std::vector<std::unique_ptr<OceanStateF>> states;
+    std::vector<OceanStateF *> pointers;
+    std::vector<int> strides; // Taille de la cascade 0 / taille de la cascade c
+
+    // Surface combinée, sur la grille de la cascade 0 (vides avec une seule cascade)
+    std::vector<float> combinedHeights;
+    std::vector<std::complex<float>> combinedDisplacements;
+    std::vector<std::complex<float>> combinedSlopes;
+    std::vector<float> combinedJacobian;
+
+    void combine();
+
+public:
+    OceanCascades(int resolution, int count);
+    // bands du plus grand au plus petit domaine, dans des rapports de puissances de deux
+    OceanCascades(int resolution, const std::vector<SpectrumBand> &bands);
+    OceanCascades(const OceanCascades &) = delete;
+    OceanCascades &operator=(const OceanCascades &) = delete;
+
+    // Bandes par défaut : domaines PATCH_SIZE * 4^(count - 1 - c)
+    static std::vector<SpectrumBand> defaultBands(int resolution, int count);
+
+    // Cascade c tirée avec la graine seed + c ; parameters.patchSize est ignoré,
+    // et parameters.pruneThreshold s'applique à chaque cascade séparément
+    void generate(unsigned seed, const OceanParameters &parameters = OceanParameters());
+    void setupPhaseRotors(float t0, float dt, int resyncInterval = 256);
+    void update(float t); // UpdateHeights de toutes les cascades, puis combinaison
+    void step();          // StepHeights de toutes les cascades, puis combinaison
+
+    int getResolution() const;
+    int getCascadeCount() const;
+    float getPatchSize() const; // Période de la surface combinée (cascade 0)
+    const SpectrumBand &band(int cascade) const;
+    OceanStateF &cascade(int cascade);
+    const OceanStateF &cascade(int cascade) const;
+
+    // Surface combinée sur la grille de la cascade 0 (mêmes conventions que OceanStateF)
+    Span<const float> heights() const;
+    Span<const std::complex<float>> displacements() const;
+    Span<const std::complex<float>> slopes() const;
+    Span<const float> jacobian() const;
+};
+
+#endif // OCEANCASCADES_H
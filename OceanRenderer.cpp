@@ -0,0 +1,349 @@
+#include "OceanRenderer.hh"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <glm/gtc/type_ptr.hpp>
+
+namespace
+{
+    // GLSL 1.20 ; les positions sont en cellules, relatives à la tuile
+    const char *VERTEX_SHADER = R"(
+uniform mat4 viewProjection;
+uniform vec2 tileOffset;
+attribute vec2 grid;
+attribute float height;
+attribute vec3 position;
+attribute vec3 normal;
+varying float surfaceHeight;
+varying vec3 surfaceNormal;
+
+void main()
+{
+#ifdef HAS_POSITION
+    vec3 p = position;
+#else
+    vec3 p = vec3(grid.x, height, grid.y);
+#endif
+#ifdef HAS_NORMAL
+    surfaceNormal = normal;
+#else
+    surfaceNormal = vec3(0.0, 1.0, 0.0);
+#endif
+    surfaceHeight = p.y;
+    gl_Position = viewProjection * vec4(p.x + tileOffset.x, p.y, p.z + tileOffset.y, 1.0);
+}
+)";
+
+    // Dégradé de l'ancien drawTriangles : hauteurs 0 à 15, du bleu sombre au bleu clair
+    const char *FRAGMENT_SHADER = R"(
+uniform vec3 sunDirection;
+varying float surfaceHeight;
+varying vec3 surfaceNormal;
+
+void main()
+{
+    const float minHeight = 0.0;
+    const float maxHeight = 15.0;
+    const vec3 darkColor = vec3(0.0, 0.0, 0.08);
+    const vec3 lightColor = vec3(0.0, 0.0, 0.8);
+    float normalizedHeight = (surfaceHeight - minHeight) / (maxHeight - minHeight);
+    vec3 color = mix(darkColor, lightColor, normalizedHeight);
+#ifdef HAS_NORMAL
+    color *= 0.4 + 0.6 * max(dot(normalize(surfaceNormal), sunDirection), 0.0);
+#endif
+    gl_FragColor = vec4(color, 1.0);
+}
+)";
+
+    GLuint compileShader(GLenum type, const std::string &source)
+    {
+        const GLuint shader = glCreateShader(type);
+        const char *text = source.c_str();
+        glShaderSource(shader, 1, &text, nullptr);
+        glCompileShader(shader);
+
+        GLint status = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+        if (status != GL_TRUE)
+        {
+            char log[1024] = "";
+            glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+            glDeleteShader(shader);
+            throw std::runtime_error(std::string("OceanRenderer: compilation du shader impossible : ") + log);
+        }
+        return shader;
+    }
+}
+
+OceanRenderer::OceanRenderer(int size, VertexFormat format, int levelCount, bool allowPersistent)
+    : size(size), format(format), topology(TileTopology::get(size, levelCount)),
+      frameBytes(topology.vertexCount() * format * sizeof(float)), program(0), gridBuffer(0),
+      indexBuffer(0), streamBuffers(), fences(), mapped(nullptr), region(STREAM_REGIONS - 1), uploaded(false)
+{
+    createProgram();
+    createBuffers(allowPersistent);
+    pendingStats = RenderStats(); // Les buffers statiques ne comptent que dans total()
+}
+
+OceanRenderer::~OceanRenderer()
+{
+    for (GLsync fence : fences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+    }
+    if (mapped)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, streamBuffers[0]);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    glDeleteBuffers(STREAM_REGIONS, streamBuffers);
+    glDeleteBuffers(1, &indexBuffer);
+    glDeleteBuffers(1, &gridBuffer);
+    glDeleteProgram(program);
+}
+
+void OceanRenderer::createProgram()
+{
+    std::string defines = "#version 120\n";
+    if (format != VERTEX_HEIGHT)
+        defines += "#define HAS_POSITION\n";
+    if (format == VERTEX_POSITION_NORMAL)
+        defines += "#define HAS_NORMAL\n";
+
+    const GLuint vertexShader = compileShader(GL_VERTEX_SHADER, defines + VERTEX_SHADER);
+    const GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, defines + FRAGMENT_SHADER);
+    program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        char log[1024] = "";
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+        throw std::runtime_error(std::string("OceanRenderer: édition de liens des shaders impossible : ") + log);
+    }
+
+    // -1 pour les attributs éliminés par le préprocesseur
+    gridLocation = glGetAttribLocation(program, "grid");
+    heightLocation = glGetAttribLocation(program, "height");
+    positionLocation = glGetAttribLocation(program, "position");
+    normalLocation = glGetAttribLocation(program, "normal");
+    sunDirectionLocation = glGetUniformLocation(program, "sunDirection");
+    viewProjectionLocation = glGetUniformLocation(program, "viewProjection");
+    tileOffsetLocation = glGetUniformLocation(program, "tileOffset");
+    setSunDirection(0.0f, 1.0f, 0.0f);
+}
+
+void OceanRenderer::createBuffers(bool allowPersistent)
+{
+    // Grille (x, z) : seulement utile quand le flux ne contient que les hauteurs
+    if (format == VERTEX_HEIGHT)
+    {
+        const int n = size + 1;
+        std::vector<float> grid(2 * topology.vertexCount());
+        for (int i = 0; i < n; ++i)
+        {
+            for (int j = 0; j < n; ++j)
+            {
+                grid[2 * (i * n + j)] = i;
+                grid[2 * (i * n + j) + 1] = j;
+            }
+        }
+        glGenBuffers(1, &gridBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, gridBuffer);
+        glBufferData(GL_ARRAY_BUFFER, grid.size() * sizeof(float), grid.data(), GL_STATIC_DRAW);
+        countUpload(grid.size() * sizeof(float));
+    }
+
+    glGenBuffers(1, &indexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, topology.indexCount() * topology.indexSize(), topology.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    countUpload(topology.indexCount() * topology.indexSize());
+
+    if (allowPersistent && GLEW_ARB_buffer_storage)
+    {
+        // Un seul buffer de STREAM_REGIONS frames, projeté une fois pour toutes
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, streamBuffers);
+        glBindBuffer(GL_ARRAY_BUFFER, streamBuffers[0]);
+        glBufferStorage(GL_ARRAY_BUFFER, STREAM_REGIONS * frameBytes, nullptr, flags);
+        mapped = static_cast<unsigned char *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, STREAM_REGIONS * frameBytes, flags));
+        if (!mapped)
+            throw std::runtime_error("OceanRenderer: projection du buffer de sommets impossible");
+    }
+    else
+    {
+        staging.resize(frameBytes / sizeof(float));
+        glGenBuffers(STREAM_REGIONS, streamBuffers);
+        for (GLuint buffer : streamBuffers)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+            glBufferData(GL_ARRAY_BUFFER, frameBytes, nullptr, GL_STREAM_DRAW);
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void OceanRenderer::countUpload(std::size_t bytes)
+{
+    pendingStats.bytesUploaded += bytes;
+    totalStats.bytesUploaded += bytes;
+}
+
+// Grille size² -> (size + 1)² : la dernière colonne et la dernière ligne
+// répètent la première, décalées d'une période quand x et z sont transmis
+void OceanRenderer::writePeriodic(Span<const float> vertices, float *target) const
+{
+    const std::size_t stride = format;
+    const std::size_t rowFloats = size * stride;
+    for (int i = 0; i <= size; ++i)
+    {
+        const float *row = vertices.data() + (i % size) * rowFloats;
+        float *out = target + i * (rowFloats + stride);
+        std::copy(row, row + rowFloats, out);
+        std::copy(row, row + stride, out + rowFloats);
+        if (format != VERTEX_HEIGHT)
+        {
+            out[rowFloats + 2] += size; // z
+            if (i == size)
+            {
+                for (std::size_t k = 0; k < rowFloats + stride; k += stride)
+                    out[k] += size; // x
+            }
+        }
+    }
+}
+
+void OceanRenderer::upload(Span<const float> vertices)
+{
+    if (vertices.size() != static_cast<std::size_t>(size) * size * format)
+        throw std::invalid_argument("OceanRenderer: taille des sommets différente de la grille");
+
+    region = (region + 1) % STREAM_REGIONS;
+
+    if (mapped)
+    {
+        // La région a été lue par le draw d'il y a STREAM_REGIONS frames : en
+        // général déjà terminé, sinon on attend le GPU plutôt que d'écraser
+        GLsync &fence = fences[region];
+        if (fence)
+        {
+            if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+            {
+                ++pendingStats.fenceWaits;
+                ++totalStats.fenceWaits;
+                glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+            }
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+        writePeriodic(vertices, reinterpret_cast<float *>(mapped + region * frameBytes));
+    }
+    else
+    {
+        writePeriodic(vertices, staging.data());
+        glBindBuffer(GL_ARRAY_BUFFER, streamBuffers[region]);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, frameBytes, staging.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    countUpload(frameBytes);
+    uploaded = true;
+}
+
+void OceanRenderer::draw(const glm::mat4 &viewProjection, const std::vector<TileDraw> &tiles)
+{
+    if (!uploaded)
+        return;
+
+    glUseProgram(program);
+    glUniformMatrix4fv(viewProjectionLocation, 1, GL_FALSE, glm::value_ptr(viewProjection));
+    const GLsizei stride = format * sizeof(float);
+    const std::size_t offset = mapped ? region * frameBytes : 0;
+    glBindBuffer(GL_ARRAY_BUFFER, mapped ? streamBuffers[0] : streamBuffers[region]);
+    const unsigned char *base = reinterpret_cast<const unsigned char *>(offset);
+    if (format == VERTEX_HEIGHT)
+    {
+        glEnableVertexAttribArray(heightLocation);
+        glVertexAttribPointer(heightLocation, 1, GL_FLOAT, GL_FALSE, stride, base);
+        glBindBuffer(GL_ARRAY_BUFFER, gridBuffer);
+        glEnableVertexAttribArray(gridLocation);
+        glVertexAttribPointer(gridLocation, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    }
+    else
+    {
+        glEnableVertexAttribArray(positionLocation);
+        glVertexAttribPointer(positionLocation, 3, GL_FLOAT, GL_FALSE, stride, base);
+        if (normalLocation >= 0)
+        {
+            glEnableVertexAttribArray(normalLocation);
+            glVertexAttribPointer(normalLocation, 3, GL_FLOAT, GL_FALSE, stride, base + 3 * sizeof(float));
+        }
+    }
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    const GLenum indexType = topology.indexSize() == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    for (const TileDraw &tile : tiles)
+    {
+        // Intérieur du niveau et bordure cousue selon les voisines
+        const TileTopology::Range ranges[2] = {topology.interior(tile.lod), topology.border(tile.lod, tile.stitch)};
+        GLsizei counts[2];
+        const void *offsets[2];
+        for (int k = 0; k < 2; ++k)
+        {
+            counts[k] = static_cast<GLsizei>(ranges[k].count);
+            offsets[k] = reinterpret_cast<const void *>(ranges[k].first * topology.indexSize());
+        }
+        glUniform2f(tileOffsetLocation, static_cast<float>(tile.x), static_cast<float>(tile.z));
+        glMultiDrawElements(GL_TRIANGLES, counts, indexType, offsets, 2);
+        ++pendingStats.drawCalls;
+        pendingStats.triangles += topology.triangleCount(tile.lod);
+    }
+    pendingStats.frames = 1;
+    ++totalStats.frames;
+    totalStats.drawCalls += pendingStats.drawCalls;
+    totalStats.triangles += pendingStats.triangles;
+    frameStats = pendingStats;
+    pendingStats = RenderStats();
+
+    // Un nouveau dessin sans upload relit la même région : sa fence remplace
+    // la précédente, qui est libérée
+    if (mapped)
+    {
+        if (fences[region])
+            glDeleteSync(fences[region]);
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    for (GLint location : {gridLocation, heightLocation, positionLocation, normalLocation})
+    {
+        if (location >= 0)
+            glDisableVertexAttribArray(location);
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glUseProgram(0);
+}
+
+void OceanRenderer::setSunDirection(float x, float y, float z)
+{
+    if (sunDirectionLocation < 0)
+        return;
+    const float inverseLength = 1.0f / std::sqrt(x * x + y * y + z * z);
+    glUseProgram(program);
+    glUniform3f(sunDirectionLocation, x * inverseLength, y * inverseLength, z * inverseLength);
+    glUseProgram(0);
+}
+
+bool OceanRenderer::isPersistent() const { return mapped != nullptr; }
+const RenderStats &OceanRenderer::lastFrame() const { return frameStats; }
+const RenderStats &OceanRenderer::total() const { return totalStats; }
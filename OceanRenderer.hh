@@ -0,0 +1,89 @@
+#ifndef OCEANRENDERER_H
+#define OCEANRENDERER_H
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Span.hh"
+#include "Mesh.hh"
+#include "MeshTopology.hh"
+#include "OceanTiles.hh"
+
+// Compteurs de rendu, par frame et cumulés
+struct RenderStats
+{
+    std::uint64_t frames = 0;
+    std::uint64_t drawCalls = 0; // Un par tuile dessinée
+    std::uint64_t triangles = 0;
+    std::uint64_t bytesUploaded = 0;
+    std::uint64_t fenceWaits = 0; // Attentes d'une région encore lue par le GPU
+};
+
+// Rendu de la surface en mode retenu : la grille (x, z) et les indices des
+// niveaux de détail (TileTopology) sont dans des buffers statiques, envoyés une
+// seule fois ; seuls les sommets de la frame (sortie de VertexBuilder) sont
+// transmis à chaque upload(), complétés d'une ligne et d'une colonne répétant
+// la première pour que les tuiles se raccordent. Le flux tourne sur
+// STREAM_REGIONS régions : un buffer projeté en mémoire de façon persistante,
+// protégé par des fences (GL_ARB_buffer_storage), ou à défaut autant de VBO
+// remplis à tour de rôle par glBufferSubData.
+// Le dégradé de couleur selon la hauteur est calculé par les shaders.
+class OceanRenderer
+{
+public:
+    static const int STREAM_REGIONS = 3;
+
+private:
+    int size;
+    VertexFormat format;
+    const TileTopology &topology;
+    std::size_t frameBytes;     // Octets de sommets par frame, grille (size + 1)²
+    std::vector<float> staging; // Frame complétée, sans projection persistante
+
+    GLuint program;
+    GLuint gridBuffer;
+    GLuint indexBuffer;
+    GLuint streamBuffers[STREAM_REGIONS];
+    GLsync fences[STREAM_REGIONS];
+    unsigned char *mapped; // Buffer persistant projeté, ou nullptr
+    int region;            // Région de la dernière frame envoyée
+    bool uploaded;
+
+    GLint gridLocation;
+    GLint heightLocation;
+    GLint positionLocation;
+    GLint normalLocation;
+    GLint sunDirectionLocation;
+    GLint viewProjectionLocation;
+    GLint tileOffsetLocation;
+
+    RenderStats pendingStats; // Frame en cours, jusqu'au draw()
+    RenderStats frameStats;
+    RenderStats totalStats;
+
+    void createProgram();
+    void createBuffers(bool allowPersistent);
+    void countUpload(std::size_t bytes);
+    void writePeriodic(Span<const float> vertices, float *target) const;
+
+public:
+    // Nécessite un contexte OpenGL courant (2.1 + VBO au minimum)
+    OceanRenderer(int size, VertexFormat format, int levelCount, bool allowPersistent = true);
+    ~OceanRenderer();
+    OceanRenderer(const OceanRenderer &) = delete;
+    OceanRenderer &operator=(const OceanRenderer &) = delete;
+
+    // Sommets de la frame, au format donné à la construction. Facultatif : sans
+    // upload(), draw() redessine les derniers sommets envoyés.
+    void upload(Span<const float> vertices);
+    // Un glMultiDrawElements par tuile (intérieur et bordure), termine la frame
+    void draw(const glm::mat4 &viewProjection, const std::vector<TileDraw> &tiles);
+
+    void setSunDirection(float x, float y, float z); // Éclairage diffus (VERTEX_POSITION_NORMAL)
+    bool isPersistent() const;
+    const RenderStats &lastFrame() const; // Dernière frame dessinée, upload compris
+    const RenderStats &total() const;
+};
+
+#endif // OCEANRENDERER_H
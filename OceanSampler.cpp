@@ -0,0 +1,149 @@
+#include "OceanSampler.hh"
+#include "OceanCascades.hh"
+#include "ThreadPool.hh"
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    // Points par bloc de parallelFor : assez pour amortir la répartition
+    const int SAMPLE_BLOCK = 4096;
+    // Points traités ensemble par cascade quand il y en a plusieurs (tampons sur la pile)
+    const std::size_t LAYER_CHUNK = 256;
+}
+
+OceanSampler::OceanSampler(const OceanStateF &state)
+    : OceanSampler(state.getResolution(), state.heights(), state.displacements(), state.getChoppiness(), state.getPatchSize())
+{
+}
+
+OceanSampler::OceanSampler(int size, Span<const float> heights, Span<const std::complex<float>> displacements,
+                           float choppiness, float patchSize)
+    : layerCount(1)
+{
+    const std::size_t cellCount = static_cast<std::size_t>(size) * size;
+    if (size < 1 || (size & (size - 1)) != 0)
+        throw std::invalid_argument("OceanSampler: la taille doit être une puissance de deux");
+    if (!(patchSize > 0))
+        throw std::invalid_argument("OceanSampler: taille du domaine invalide");
+    if (heights.size() != cellCount || (!displacements.empty() && displacements.size() != cellCount))
+        throw std::invalid_argument("OceanSampler: tailles des champs incohérentes");
+
+    layers[0].heights = heights.data();
+    layers[0].displacements = displacements.empty() ? nullptr : displacements.data();
+    layers[0].size = size;
+    layers[0].cellsPerMeter = size / patchSize;
+    layers[0].choppiness = choppiness;
+}
+
+OceanSampler::OceanSampler(const OceanCascades &cascades)
+    : layerCount(cascades.getCascadeCount())
+{
+    for (int c = 0; c < layerCount; ++c)
+    {
+        const OceanStateF &state = cascades.cascade(c);
+        layers[c].heights = state.heights().data();
+        layers[c].displacements = state.displacements().data();
+        layers[c].size = state.getResolution();
+        layers[c].cellsPerMeter = state.getResolution() / state.getPatchSize();
+        layers[c].choppiness = state.getChoppiness();
+    }
+}
+
+void OceanSampler::check(int iterations, bool displacementsOut) const
+{
+    if (iterations < 0)
+        throw std::invalid_argument("OceanSampler: nombre d'itérations invalide");
+    if ((iterations > 0 || displacementsOut) && !layers[0].displacements)
+        throw std::invalid_argument("OceanSampler: pas de déplacements dans cette frame");
+}
+
+float OceanSampler::height(float x, float z, SampleFilter filter, int iterations) const
+{
+    check(iterations, false);
+    float h;
+    sampleBlock(filter, iterations, 1, &x, &z, &h, nullptr, nullptr);
+    return h;
+}
+
+void OceanSampler::sampleBlock(SampleFilter filter, int iterations, std::size_t count, const float *x, const float *z, float *heights,
+                               float *displacementX, float *displacementZ) const
+{
+    if (layerCount == 1)
+    {
+        sampleSurfaceKernel(layers[0], filter, iterations, count, x, z, heights, displacementX, displacementZ);
+        return;
+    }
+
+    // Plusieurs cascades : l'inversion porte sur la somme de leurs déplacements,
+    // chaque itération échantillonne toutes les cascades au point courant
+    float px[LAYER_CHUNK], pz[LAYER_CHUNK], h[LAYER_CHUNK], dx[LAYER_CHUNK], dz[LAYER_CHUNK];
+    float sumX[LAYER_CHUNK], sumZ[LAYER_CHUNK];
+    for (std::size_t begin = 0; begin < count; begin += LAYER_CHUNK)
+    {
+        const std::size_t n = std::min(LAYER_CHUNK, count - begin);
+        std::copy(x + begin, x + begin + n, px);
+        std::copy(z + begin, z + begin + n, pz);
+        for (int k = 0; k <= iterations; ++k)
+        {
+            const bool last = k == iterations;
+            const bool withDisplacements = !last || displacementX;
+            std::fill(sumX, sumX + n, 0.0f);
+            std::fill(sumZ, sumZ + n, 0.0f);
+            if (last)
+                std::fill(heights + begin, heights + begin + n, 0.0f);
+            for (int c = 0; c < layerCount; ++c)
+            {
+                sampleSurfaceKernel(layers[c], filter, 0, n, px, pz, h, withDisplacements ? dx : nullptr, withDisplacements ? dz : nullptr);
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    if (last)
+                        heights[begin + i] += h[i];
+                    if (withDisplacements)
+                    {
+                        sumX[i] += dx[i];
+                        sumZ[i] += dz[i];
+                    }
+                }
+            }
+            if (!last)
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    px[i] = x[begin + i] - sumX[i];
+                    pz[i] = z[begin + i] - sumZ[i];
+                }
+            }
+            else if (displacementX)
+            {
+                std::copy(sumX, sumX + n, displacementX + begin);
+                std::copy(sumZ, sumZ + n, displacementZ + begin);
+            }
+        }
+    }
+}
+
+void OceanSampler::sample(Span<const float> x, Span<const float> z, Span<float> heights, SampleFilter filter, int iterations,
+                          Span<float> displacementX, Span<float> displacementZ) const
+{
+    const std::size_t count = x.size();
+    const bool displacementsOut = !displacementX.empty() || !displacementZ.empty();
+    if (z.size() != count || heights.size() != count ||
+        (displacementsOut && (displacementX.size() != count || displacementZ.size() != count)))
+        throw std::invalid_argument("OceanSampler::sample: tailles incohérentes");
+    check(iterations, displacementsOut);
+
+    const int blocks = static_cast<int>((count + SAMPLE_BLOCK - 1) / SAMPLE_BLOCK);
+    ThreadPool &pool = ThreadPool::shared();
+    pool.parallelFor(0, blocks, pool.grainFor(blocks), [&](int first, int last)
+    {
+        const std::size_t begin = static_cast<std::size_t>(first) * SAMPLE_BLOCK;
+        const std::size_t end = std::min(count, static_cast<std::size_t>(last) * SAMPLE_BLOCK);
+        sampleBlock(filter, iterations, end - begin, x.data() + begin, z.data() + begin, heights.data() + begin,
+                    displacementsOut ? displacementX.data() + begin : nullptr, displacementsOut ? displacementZ.data() + begin : nullptr);
+    });
+}
+
+int OceanSampler::getSize() const { return layers[0].size; }
+
+float OceanSampler::getPatchSize() const { return layers[0].size / layers[0].cellsPerMeter; }
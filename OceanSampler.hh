@@ -0,0 +1,53 @@
+#ifndef OCEANSAMPLER_H
+#define OCEANSAMPLER_H
+
+#include <complex>
+#include <cstddef>
+#include "OceanState.hh"
+#include "SimdKernels.hh"
+#include "Span.hh"
+#include "heightmap.hh"
+
+class OceanCascades;
+
+// Requêtes de hauteur de la surface à des positions quelconques (flottabilité,
+// collisions, sillages...) sur une vue en lecture seule d'une frame : la
+// grille size x size couvre patchSize mètres et se répète, l'axe x suit i et
+// l'axe z suit j. Les données ne sont pas copiées et doivent survivre à l'objet.
+//
+// Avec iterations > 0, les déplacements horizontaux sont inversés : on cherche
+// le point p de la grille que choppiness D(p) amène en (x, z), ce qui donne la
+// hauteur de la surface déplacée, celle qui est affichée. Deux ou trois
+// itérations suffisent tant que la surface ne se replie pas (jacobien > 0).
+class OceanSampler
+{
+private:
+    SurfaceFieldsF layers[MAX_CASCADES]; // Une par cascade, sommées
+    int layerCount;
+
+    void check(int iterations, bool displacementsOut) const;
+    void sampleBlock(SampleFilter filter, int iterations, std::size_t count, const float *x, const float *z, float *heights,
+                     float *displacementX, float *displacementZ) const;
+
+public:
+    // Domaine et choppiness de state (voir GenerateSpectra)
+    explicit OceanSampler(const OceanStateF &state);
+    // displacements (x + iz, en mètres) peut être vide : ni inversion ni déplacements en sortie
+    OceanSampler(int size, Span<const float> heights, Span<const std::complex<float>> displacements,
+                 float choppiness = CHOPPINESS, float patchSize = PATCH_SIZE);
+    // Somme des cascades, chacune échantillonnée sur sa propre période : les
+    // détails des petites cascades ne sont pas perdus comme sur la grille combinée
+    explicit OceanSampler(const OceanCascades &cascades);
+
+    float height(float x, float z, SampleFilter filter = SAMPLE_BILINEAR, int iterations = 0) const;
+
+    // Lot de points en SoA, réparti sur ThreadPool::shared(). displacementX et
+    // displacementZ (choppiness D au point de la grille, en mètres) sont optionnels.
+    void sample(Span<const float> x, Span<const float> z, Span<float> heights, SampleFilter filter = SAMPLE_BILINEAR,
+                int iterations = 0, Span<float> displacementX = Span<float>(), Span<float> displacementZ = Span<float>()) const;
+
+    int getSize() const;
+    float getPatchSize() const; // Période de la surface (plus grande cascade)
+};
+
+#endif // OCEANSAMPLER_H
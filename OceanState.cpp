@@ -0,0 +1,176 @@
+#include "OceanState.hh"
+#include "heightmap.hh"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace
+{
+    std::size_t alignUp(std::size_t size, std::size_t alignment)
+    {
+        return (size + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+template <typename Real>
+BasicOceanState<Real>::BasicOceanState(int resolution)
+    : resolution(resolution), arena(nullptr), arenaSize(0), choppiness(CHOPPINESS), patchSize(PATCH_SIZE)
+{
+    if (!isSupportedResolution(resolution))
+        throw std::invalid_argument("OceanState: résolution non supportée (puissance de deux entre 64 et 2048)");
+
+    const std::size_t cells = cellCount();
+    const std::size_t complexBytes = alignUp(cells * sizeof(ComplexT), ALIGNMENT);
+    const std::size_t realBytes = alignUp(cells * sizeof(Real), ALIGNMENT);
+    const std::size_t spanBytes = alignUp(4 * static_cast<std::size_t>(resolution) * sizeof(int), ALIGNMENT);
+    const std::size_t rowBytes = alignUp(resolution, ALIGNMENT);
+
+    arenaSize = 10 * complexBytes + 3 * realBytes + spanBytes + rowBytes;
+    arena = static_cast<unsigned char *>(std::aligned_alloc(ALIGNMENT, arenaSize));
+    if (!arena)
+        throw std::bad_alloc();
+    std::memset(arena, 0, arenaSize);
+
+    unsigned char *cursor = arena;
+    spectrum0Data = reinterpret_cast<ComplexT *>(cursor);
+    cursor += complexBytes;
+    spectrum0MirrorData = reinterpret_cast<ComplexT *>(cursor);
+    cursor += complexBytes;
+    directionsData = reinterpret_cast<ComplexT *>(cursor);
+    cursor += complexBytes;
+    waveVectorsData = reinterpret_cast<ComplexT *>(cursor);
+    cursor += complexBytes;
+    spectrumData = reinterpret_cast<ComplexT *>(cursor);
+    cursor += complexBytes;
+    jacobianSpectrumData = reinterpret_cast<ComplexT *>(cursor);
+    cursor += complexBytes;
+    displacementsData = reinterpret_cast<ComplexT *>(cursor);
+    cursor += complexBytes;
+    slopesData = reinterpret_cast<ComplexT *>(cursor);
+    cursor += complexBytes;
+    phasesData = reinterpret_cast<ComplexT *>(cursor);
+    cursor += complexBytes;
+    rotorsData = reinterpret_cast<ComplexT *>(cursor);
+    cursor += complexBytes;
+    angularSpeedsData = reinterpret_cast<Real *>(cursor);
+    cursor += realBytes;
+    heightsData = reinterpret_cast<Real *>(cursor);
+    cursor += realBytes;
+    jacobianData = reinterpret_cast<Real *>(cursor);
+    cursor += realBytes;
+    activeSpansData = reinterpret_cast<int *>(cursor);
+    cursor += spanBytes;
+    activeRowsData = cursor;
+
+    // Sans élagage, tout le spectre est actif
+    for (int row = 0; row < resolution; ++row)
+    {
+        for (int half = 0; half < 2; ++half)
+        {
+            activeSpansData[4 * row + 2 * half] = half * resolution / 2;
+            activeSpansData[4 * row + 2 * half + 1] = (half + 1) * resolution / 2;
+        }
+        activeRowsData[row] = 1;
+    }
+    pruning.activeCells = cells;
+    pruning.activeRows = resolution;
+}
+
+template <typename Real>
+BasicOceanState<Real>::~BasicOceanState()
+{
+    std::free(arena);
+}
+
+template <typename Real>
+int BasicOceanState<Real>::getResolution() const { return resolution; }
+template <typename Real>
+std::size_t BasicOceanState<Real>::cellCount() const { return static_cast<std::size_t>(resolution) * resolution; }
+
+template <typename Real>
+void BasicOceanState<Real>::copySpectrumFrom(const BasicOceanState &other)
+{
+    if (other.resolution != resolution)
+        throw std::invalid_argument("OceanState: copie entre résolutions différentes");
+
+    const std::size_t cells = cellCount();
+    std::memcpy(spectrum0Data, other.spectrum0Data, cells * sizeof(ComplexT));
+    std::memcpy(spectrum0MirrorData, other.spectrum0MirrorData, cells * sizeof(ComplexT));
+    std::memcpy(directionsData, other.directionsData, cells * sizeof(ComplexT));
+    std::memcpy(waveVectorsData, other.waveVectorsData, cells * sizeof(ComplexT));
+    std::memcpy(angularSpeedsData, other.angularSpeedsData, cells * sizeof(Real));
+    std::memcpy(activeSpansData, other.activeSpansData, 4 * static_cast<std::size_t>(resolution) * sizeof(int));
+    std::memcpy(activeRowsData, other.activeRowsData, resolution);
+    choppiness = other.choppiness;
+    patchSize = other.patchSize;
+    pruning = other.pruning;
+}
+
+template <typename Real>
+float BasicOceanState<Real>::getChoppiness() const { return choppiness; }
+template <typename Real>
+void BasicOceanState<Real>::setChoppiness(float lambda) { choppiness = lambda; }
+template <typename Real>
+float BasicOceanState<Real>::getPatchSize() const { return patchSize; }
+template <typename Real>
+void BasicOceanState<Real>::setPatchSize(float size) { patchSize = size; }
+
+template <typename Real>
+Span<std::complex<Real>> BasicOceanState<Real>::spectrum0() { return Span<ComplexT>(spectrum0Data, cellCount()); }
+template <typename Real>
+Span<std::complex<Real>> BasicOceanState<Real>::spectrum0Mirror() { return Span<ComplexT>(spectrum0MirrorData, cellCount()); }
+template <typename Real>
+Span<std::complex<Real>> BasicOceanState<Real>::directions() { return Span<ComplexT>(directionsData, cellCount()); }
+template <typename Real>
+Span<std::complex<Real>> BasicOceanState<Real>::waveVectors() { return Span<ComplexT>(waveVectorsData, cellCount()); }
+template <typename Real>
+Span<Real> BasicOceanState<Real>::angularSpeeds() { return Span<Real>(angularSpeedsData, cellCount()); }
+template <typename Real>
+Span<std::complex<Real>> BasicOceanState<Real>::spectrum() { return Span<ComplexT>(spectrumData, cellCount()); }
+template <typename Real>
+Span<std::complex<Real>> BasicOceanState<Real>::jacobianSpectrum() { return Span<ComplexT>(jacobianSpectrumData, cellCount()); }
+template <typename Real>
+Span<Real> BasicOceanState<Real>::heights() { return Span<Real>(heightsData, cellCount()); }
+template <typename Real>
+Span<std::complex<Real>> BasicOceanState<Real>::displacements() { return Span<ComplexT>(displacementsData, cellCount()); }
+template <typename Real>
+Span<std::complex<Real>> BasicOceanState<Real>::slopes() { return Span<ComplexT>(slopesData, cellCount()); }
+template <typename Real>
+Span<Real> BasicOceanState<Real>::jacobian() { return Span<Real>(jacobianData, cellCount()); }
+template <typename Real>
+Span<std::complex<Real>> BasicOceanState<Real>::phases() { return Span<ComplexT>(phasesData, cellCount()); }
+template <typename Real>
+Span<std::complex<Real>> BasicOceanState<Real>::rotors() { return Span<ComplexT>(rotorsData, cellCount()); }
+template <typename Real>
+typename BasicOceanState<Real>::RotorClock &BasicOceanState<Real>::rotorClock() { return clock; }
+template <typename Real>
+Span<int> BasicOceanState<Real>::activeSpans() { return Span<int>(activeSpansData, 4 * static_cast<std::size_t>(resolution)); }
+template <typename Real>
+Span<unsigned char> BasicOceanState<Real>::activeRows() { return Span<unsigned char>(activeRowsData, resolution); }
+template <typename Real>
+typename BasicOceanState<Real>::SpectrumPruning &BasicOceanState<Real>::spectrumPruning() { return pruning; }
+
+template <typename Real>
+Span<const std::complex<Real>> BasicOceanState<Real>::spectrum0() const { return Span<const ComplexT>(spectrum0Data, cellCount()); }
+template <typename Real>
+Span<const std::complex<Real>> BasicOceanState<Real>::directions() const { return Span<const ComplexT>(directionsData, cellCount()); }
+template <typename Real>
+Span<const Real> BasicOceanState<Real>::angularSpeeds() const { return Span<const Real>(angularSpeedsData, cellCount()); }
+template <typename Real>
+Span<const Real> BasicOceanState<Real>::heights() const { return Span<const Real>(heightsData, cellCount()); }
+template <typename Real>
+Span<const std::complex<Real>> BasicOceanState<Real>::displacements() const { return Span<const ComplexT>(displacementsData, cellCount()); }
+template <typename Real>
+Span<const std::complex<Real>> BasicOceanState<Real>::slopes() const { return Span<const ComplexT>(slopesData, cellCount()); }
+template <typename Real>
+Span<const Real> BasicOceanState<Real>::jacobian() const { return Span<const Real>(jacobianData, cellCount()); }
+template <typename Real>
+Span<const int> BasicOceanState<Real>::activeSpans() const { return Span<const int>(activeSpansData, 4 * static_cast<std::size_t>(resolution)); }
+template <typename Real>
+Span<const unsigned char> BasicOceanState<Real>::activeRows() const { return Span<const unsigned char>(activeRowsData, resolution); }
+template <typename Real>
+const typename BasicOceanState<Real>::SpectrumPruning &BasicOceanState<Real>::spectrumPruning() const { return pruning; }
+
+template class BasicOceanState<double>;
+template class BasicOceanState<float>;
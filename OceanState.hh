@@ -0,0 +1,120 @@
+#ifndef OCEANSTATE_H
+#define OCEANSTATE_H
+
+#include <complex>
+#include <cstddef>
+#include "Span.hh"
+#include "Resolution.hh"
+
+// État de la simulation pour une grille resolution x resolution, en simple
+// (float) ou double précision.
+// Tous les buffers sont découpés dans une seule allocation alignée sur 64 octets,
+// faite à la construction : une frame en régime permanent n'alloue plus rien.
+template <typename Real>
+class BasicOceanState
+{
+public:
+    typedef std::complex<Real> ComplexT;
+    static constexpr std::size_t ALIGNMENT = 64;
+
+    // Horloge de l'évolution à pas fixe par rotors de phase (voir SetupPhaseRotors)
+    struct RotorClock
+    {
+        bool enabled = false;
+        double time = 0.0;         // Instant de la prochaine frame calculée par StepHeights
+        double step = 0.0;         // Pas de temps fixe
+        int resyncInterval = 0;    // Recalcul exact des phases toutes les resyncInterval étapes
+        int stepsSinceResync = 0;
+    };
+
+    // Élagage du spectre par GenerateSpectra : seules les cellules actives sont
+    // évoluées, et l'IFFT saute les lignes entièrement nulles
+    struct SpectrumPruning
+    {
+        float threshold = 0;         // Part de l'énergie de h0 autorisée à être écartée
+        double discardedEnergy = 0;  // Part effectivement écartée
+        std::size_t activeCells = 0; // Cellules dont h0(k) ou h0(-k) est non nul
+        int activeRows = 0;          // Lignes non nulles des spectres transformés
+    };
+
+private:
+    int resolution;
+    unsigned char *arena;
+    std::size_t arenaSize;
+
+    ComplexT *spectrum0Data;        // Spectre initial h0(k)
+    ComplexT *spectrum0MirrorData;  // conj(h0(-k)), précalculé pour l'évolution
+    ComplexT *directionsData;       // Direction k / |k| sous forme kx + i ky
+    ComplexT *waveVectorsData;      // Vecteur d'onde k sous forme kx + i ky
+    Real *angularSpeedsData;        // Pulsations w(k)
+    ComplexT *spectrumData;         // Spectre de travail h + i dDx/dz, transformé en place
+    ComplexT *jacobianSpectrumData; // Spectre de travail dDx/dx + i dDz/dz, transformé en place
+    Real *heightsData;              // Hauteurs h(x, t)
+    ComplexT *displacementsData;    // Déplacements horizontaux Dx + i Dz (spectre, puis champ)
+    ComplexT *slopesData;           // Pentes dh/dx + i dh/dz (spectre, puis champ)
+    Real *jacobianData;             // Jacobien de la surface déplacée, < 0 là où elle se replie
+    ComplexT *phasesData;           // exp(iwt) à l'instant courant (mode rotors)
+    ComplexT *rotorsData;           // exp(iw dt) (mode rotors)
+    int *activeSpansData;           // Par ligne et demi-ligne du spectre : colonnes actives [first, last)
+    unsigned char *activeRowsData;  // Par ligne des spectres décalés transformés : non nulle
+    RotorClock clock;
+    SpectrumPruning pruning;
+    float choppiness;               // lambda du jacobien, fixé par GenerateSpectra
+    float patchSize;                // Côté du domaine simulé en mètres, fixé par GenerateSpectra
+
+public:
+    explicit BasicOceanState(int resolution);
+    ~BasicOceanState();
+    BasicOceanState(const BasicOceanState &) = delete;
+    BasicOceanState &operator=(const BasicOceanState &) = delete;
+
+    int getResolution() const;
+    std::size_t cellCount() const;
+
+    // Recopie les données constantes du spectre (h0, miroir, directions, vecteurs d'onde, pulsations, choppiness, domaine, élagage)
+    void copySpectrumFrom(const BasicOceanState &other);
+
+    float getChoppiness() const;
+    void setChoppiness(float lambda);
+    float getPatchSize() const;
+    void setPatchSize(float size);
+
+    Span<ComplexT> spectrum0();
+    Span<ComplexT> spectrum0Mirror();
+    Span<ComplexT> directions();
+    Span<ComplexT> waveVectors();
+    Span<Real> angularSpeeds();
+    Span<ComplexT> spectrum();
+    Span<ComplexT> jacobianSpectrum();
+    Span<Real> heights();
+    Span<ComplexT> displacements();
+    Span<ComplexT> slopes();
+    Span<Real> jacobian();
+    Span<ComplexT> phases();
+    Span<ComplexT> rotors();
+    RotorClock &rotorClock();
+    // Colonnes actives de la demi-ligne half de la ligne row : indices 4 row + 2 half et 4 row + 2 half + 1.
+    // Toutes actives tant que GenerateSpectra n'a rien élagué.
+    Span<int> activeSpans();
+    Span<unsigned char> activeRows();
+    SpectrumPruning &spectrumPruning();
+
+    Span<const ComplexT> spectrum0() const;
+    Span<const ComplexT> directions() const;
+    Span<const Real> angularSpeeds() const;
+    Span<const Real> heights() const;
+    Span<const ComplexT> displacements() const;
+    Span<const ComplexT> slopes() const;
+    Span<const Real> jacobian() const;
+    Span<const int> activeSpans() const;
+    Span<const unsigned char> activeRows() const;
+    const SpectrumPruning &spectrumPruning() const;
+};
+
+typedef BasicOceanState<double> OceanState;
+typedef BasicOceanState<float> OceanStateF;
+
+extern template class BasicOceanState<double>;
+extern template class BasicOceanState<float>;
+
+#endif // OCEANSTATE_H
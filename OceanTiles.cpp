@@ -0,0 +1,140 @@
+#include "OceanTiles.hh"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+Frustum::Frustum(const glm::mat4 &viewProjection)
+{
+    // Lignes de la matrice (glm est en colonnes)
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; ++i)
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+
+    planes[0] = rows[3] + rows[0]; // Gauche
+    planes[1] = rows[3] - rows[0]; // Droite
+    planes[2] = rows[3] + rows[1]; // Bas
+    planes[3] = rows[3] - rows[1]; // Haut
+    planes[4] = rows[3] + rows[2]; // Proche
+    planes[5] = rows[3] - rows[2]; // Lointain
+}
+
+bool Frustum::intersects(const glm::vec3 &boxMin, const glm::vec3 &boxMax) const
+{
+    for (const glm::vec4 &plane : planes)
+    {
+        // Coin de la boîte le plus avancé dans la direction de la normale
+        const glm::vec3 corner(plane.x >= 0 ? boxMax.x : boxMin.x, plane.y >= 0 ? boxMax.y : boxMin.y,
+                               plane.z >= 0 ? boxMax.z : boxMin.z);
+        if (plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w < 0)
+            return false;
+    }
+    return true;
+}
+
+TileSelector::TileSelector(int size, int levelCount, int radius, float lodDistance, float heightMin, float heightMax,
+                           float horizontalMargin)
+    : size(size), levelCount(levelCount), radius(radius), lodDistance(lodDistance), heightMin(heightMin),
+      heightMax(heightMax), horizontalMargin(horizontalMargin),
+      levels(static_cast<std::size_t>(2 * radius + 1) * (2 * radius + 1))
+{
+    if (size < 1 || levelCount < 1 || radius < 0 || !(lodDistance > 0))
+        throw std::invalid_argument("TileSelector: paramètres invalides");
+    tiles.reserve(levels.size());
+}
+
+const std::vector<TileDraw> &TileSelector::select(const glm::vec3 &eye, const glm::mat4 &viewProjection)
+{
+    const int width = 2 * radius + 1;
+    const int centerX = static_cast<int>(std::floor(eye.x / size));
+    const int centerZ = static_cast<int>(std::floor(eye.z / size));
+    auto level = [&](int dx, int dz) -> int & { return levels[(dx + radius) * width + dz + radius]; };
+
+    // Niveau selon la distance de la caméra à la boîte de la tuile
+    for (int dx = -radius; dx <= radius; ++dx)
+    {
+        for (int dz = -radius; dz <= radius; ++dz)
+        {
+            const float x0 = static_cast<float>(centerX + dx) * size;
+            const float z0 = static_cast<float>(centerZ + dz) * size;
+            const float gx = std::max({x0 - eye.x, 0.0f, eye.x - (x0 + size)});
+            const float gy = std::max({heightMin - eye.y, 0.0f, eye.y - heightMax});
+            const float gz = std::max({z0 - eye.z, 0.0f, eye.z - (z0 + size)});
+            const float distance = std::sqrt(gx * gx + gy * gy + gz * gz);
+            const int lod = distance > lodDistance ? static_cast<int>(std::log2(distance / lodDistance)) + 1 : 0;
+            level(dx, dz) = std::min(lod, levelCount - 1);
+        }
+    }
+
+    // Au plus un niveau d'écart entre voisines : les plus grossières sont affinées
+    for (bool changed = true; changed;)
+    {
+        changed = false;
+        for (int dx = -radius; dx <= radius; ++dx)
+        {
+            for (int dz = -radius; dz <= radius; ++dz)
+            {
+                int &lod = level(dx, dz);
+                int finest = lod;
+                if (dx > -radius)
+                    finest = std::min(finest, level(dx - 1, dz));
+                if (dx < radius)
+                    finest = std::min(finest, level(dx + 1, dz));
+                if (dz > -radius)
+                    finest = std::min(finest, level(dx, dz - 1));
+                if (dz < radius)
+                    finest = std::min(finest, level(dx, dz + 1));
+                if (lod > finest + 1)
+                {
+                    lod = finest + 1;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    const Frustum frustum(viewProjection);
+    tiles.clear();
+    stats = TileSelectionStats();
+    for (int dx = -radius; dx <= radius; ++dx)
+    {
+        for (int dz = -radius; dz <= radius; ++dz)
+        {
+            ++stats.considered;
+            TileDraw tile;
+            tile.x = (centerX + dx) * size;
+            tile.z = (centerZ + dz) * size;
+            const glm::vec3 boxMin(tile.x - horizontalMargin, heightMin, tile.z - horizontalMargin);
+            const glm::vec3 boxMax(tile.x + size + horizontalMargin, heightMax, tile.z + size + horizontalMargin);
+            if (!frustum.intersects(boxMin, boxMax))
+            {
+                ++stats.culled;
+                continue;
+            }
+
+            tile.lod = level(dx, dz);
+            tile.stitch = 0;
+            if (dx > -radius && level(dx - 1, dz) > tile.lod)
+                tile.stitch |= SIDE_X_MIN;
+            if (dx < radius && level(dx + 1, dz) > tile.lod)
+                tile.stitch |= SIDE_X_MAX;
+            if (dz > -radius && level(dx, dz - 1) > tile.lod)
+                tile.stitch |= SIDE_Z_MIN;
+            if (dz < radius && level(dx, dz + 1) > tile.lod)
+                tile.stitch |= SIDE_Z_MAX;
+            const std::size_t cells = size >> tile.lod;
+            stats.triangles += 2 * cells * cells;
+            tiles.push_back(tile);
+        }
+    }
+    return tiles;
+}
+
+int TileSelector::getRadius() const { return radius; }
+
+float TileSelector::farDistance() const
+{
+    // Coin le plus éloigné, la caméra pouvant être n'importe où dans la tuile centrale
+    return std::sqrt(2.0f) * (radius + 1) * size + (heightMax - heightMin);
+}
+
+const TileSelectionStats &TileSelector::lastSelection() const { return stats; }
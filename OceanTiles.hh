@@ -0,0 +1,73 @@
+#ifndef OCEANTILES_H
+#define OCEANTILES_H
+
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+#include "MeshTopology.hh"
+
+// Pavage de l'océan jusqu'à l'horizon : le champ de hauteurs étant périodique,
+// la même grille est répétée en tuiles de size x size cellules (unités de la
+// grille, l'axe x suit i et l'axe z suit j). Le niveau de détail d'une tuile
+// augmente d'un cran chaque fois que sa distance à la caméra double, si bien
+// que chaque anneau de distance coûte à peu près le même nombre de sommets :
+// au-delà du dernier niveau, les tuiles n'ont plus qu'une cellule.
+
+// Tuile à dessiner
+struct TileDraw
+{
+    int x;           // Origine de la tuile, en cellules
+    int z;
+    int lod;         // Un sommet sur 2^lod
+    unsigned stitch; // Côtés (TileSide) dont la voisine est plus grossière
+};
+
+// Les six plans d'une matrice vue-projection (méthode de Gribb et Hartmann)
+class Frustum
+{
+private:
+    glm::vec4 planes[6]; // ax + by + cz + d >= 0 à l'intérieur
+
+public:
+    explicit Frustum(const glm::mat4 &viewProjection);
+    // Faux seulement si la boîte est entièrement hors d'un des plans
+    bool intersects(const glm::vec3 &boxMin, const glm::vec3 &boxMax) const;
+};
+
+struct TileSelectionStats
+{
+    std::size_t considered = 0; // Tuiles dans le rayon
+    std::size_t culled = 0;     // Éliminées par le frustum
+    std::size_t triangles = 0;  // Triangles des tuiles retenues
+};
+
+// Choix des tuiles dans un carré de radius tuiles autour de la caméra,
+// avec leur niveau de détail, puis élimination sur le CPU de celles hors du
+// frustum. Deux tuiles voisines diffèrent d'au plus un niveau (voir TileTopology).
+class TileSelector
+{
+private:
+    int size;
+    int levelCount;
+    int radius;
+    float lodDistance;      // Distance en deçà de laquelle le niveau 0 est utilisé
+    float heightMin;
+    float heightMax;
+    float horizontalMargin; // Extension des boîtes en x et z (déplacements horizontaux)
+    std::vector<int> levels; // Grille (2 radius + 1)² des niveaux
+    std::vector<TileDraw> tiles;
+    TileSelectionStats stats;
+
+public:
+    // heightMin et heightMax bornent y ; horizontalMargin borne les déplacements en x et z
+    TileSelector(int size, int levelCount, int radius, float lodDistance, float heightMin, float heightMax,
+                 float horizontalMargin);
+
+    const std::vector<TileDraw> &select(const glm::vec3 &eye, const glm::mat4 &viewProjection);
+
+    int getRadius() const;
+    float farDistance() const; // Distance de la tuile la plus éloignée, pour le plan lointain
+    const TileSelectionStats &lastSelection() const;
+};
+
+#endif // OCEANTILES_H
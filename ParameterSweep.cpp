@@ -0,0 +1,176 @@
+#include "ParameterSweep.hh"
+#include "ThreadPool.hh"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    // k-ième des count points régulièrement espacés sur [low, high], fallback pour un seul point
+    float axisValue(int k, int count, float low, float high, float fallback)
+    {
+        return count == 1 ? fallback : low + (high - low) * k / (count - 1);
+    }
+
+    Vector2 direction(double angle)
+    {
+        return Vector2(std::cos(angle), std::sin(angle));
+    }
+}
+
+std::vector<SeaState> sweepGrid(int windSpeeds, int directions, int choppinesses, int patchSizes, unsigned seed)
+{
+    if (windSpeeds < 1 || directions < 1 || choppinesses < 1 || patchSizes < 1)
+        throw std::invalid_argument("sweepGrid: au moins un point par axe attendu");
+
+    std::vector<SeaState> result;
+    result.reserve(static_cast<std::size_t>(windSpeeds) * directions * choppinesses * patchSizes);
+    for (int w = 0; w < windSpeeds; ++w)
+        for (int d = 0; d < directions; ++d)
+            for (int c = 0; c < choppinesses; ++c)
+                for (int p = 0; p < patchSizes; ++p)
+                {
+                    SeaState state;
+                    state.index = static_cast<int>(result.size());
+                    state.seed = seed + static_cast<unsigned>(state.index);
+                    state.parameters.windSpeed = axisValue(w, windSpeeds, WIND_SPEED_MIN, WIND_SPEED_MAX, WIND_SPEED);
+                    if (directions > 1)
+                        state.parameters.windDirection = direction(2 * M_PI * d / directions);
+                    state.parameters.choppiness = axisValue(c, choppinesses, CHOPPINESS_MIN, CHOPPINESS_MAX, CHOPPINESS);
+                    state.parameters.patchSize = axisValue(p, patchSizes, PATCH_SIZE_MIN, PATCH_SIZE_MAX, PATCH_SIZE);
+                    result.push_back(state);
+                }
+    return result;
+}
+
+std::vector<SeaState> sweepRandom(int count, unsigned seed)
+{
+    if (count < 0)
+        throw std::invalid_argument("sweepRandom: nombre d'états négatif");
+
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> windSpeed(WIND_SPEED_MIN, WIND_SPEED_MAX);
+    std::uniform_real_distribution<double> angle(0.0, 2 * M_PI);
+    std::uniform_real_distribution<float> choppiness(CHOPPINESS_MIN, CHOPPINESS_MAX);
+    std::uniform_real_distribution<float> patchSize(PATCH_SIZE_MIN, PATCH_SIZE_MAX);
+    std::vector<SeaState> result(count);
+    for (int i = 0; i < count; ++i)
+    {
+        SeaState &state = result[i];
+        state.index = i;
+        state.seed = seed + static_cast<unsigned>(i);
+        state.parameters.windSpeed = windSpeed(random);
+        state.parameters.windDirection = direction(angle(random));
+        state.parameters.choppiness = choppiness(random);
+        state.parameters.patchSize = patchSize(random);
+    }
+    return result;
+}
+
+ParameterSweep::ParameterSweep(int resolution, int firstFrame, int frameCount, float timeStep)
+    : resolution(resolution), firstFrame(firstFrame), frameCount(frameCount), timeStep(timeStep)
+{
+    if (!isSupportedResolution(resolution))
+        throw std::invalid_argument("ParameterSweep: résolution non supportée");
+    if (firstFrame < 0 || frameCount < 1)
+        throw std::invalid_argument("ParameterSweep: au moins une frame par état attendue");
+}
+
+SweepStats ParameterSweep::run(const std::vector<SeaState> &seaStates, BatchWriter &writer) const
+{
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point begin = Clock::now();
+    const int count = static_cast<int>(seaStates.size());
+    if (static_cast<long long>(count) * frameCount > std::numeric_limits<int>::max())
+        throw std::invalid_argument("ParameterSweep: trop de frames pour un seul balayage, découper avec --shard");
+
+    // Un état de simulation par thread au plus, repris d'un état de mer à l'autre
+    ThreadPool &pool = ThreadPool::shared();
+    const int workers = std::min(pool.getThreadCount(), std::max(count, 1));
+    std::vector<std::unique_ptr<OceanStateF>> states;
+    std::vector<OceanStateF *> idle;
+    for (int w = 0; w < workers; ++w)
+    {
+        states.emplace_back(new OceanStateF(resolution));
+        idle.push_back(states.back().get());
+    }
+    std::mutex mutex;
+
+    // Grain 1 : chaque thread prend l'état de mer suivant dès qu'il a fini le sien.
+    // Après une erreur, le pool ne distribue plus d'état et la relance ici.
+    pool.parallelFor(0, count, 1, [&](int first, int last)
+    {
+        for (int s = first; s < last; ++s)
+        {
+            OceanStateF *state;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                state = idle.back();
+                idle.pop_back();
+            }
+            GenerateSpectra(*state, seaStates[s].seed, seaStates[s].parameters);
+            for (int i = 0; i < frameCount; ++i)
+            {
+                UpdateHeights((firstFrame + i) * timeStep, *state);
+                writer.push(s * frameCount + i, state->heights(), state->displacements());
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            idle.push_back(state);
+        }
+    });
+    writer.finish();
+
+    SweepStats stats;
+    stats.seaStates = count;
+    stats.frames = static_cast<long long>(count) * frameCount;
+    stats.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    stats.framesPerSecond = stats.seconds > 0 ? stats.frames / stats.seconds : 0.0;
+    return stats;
+}
+
+int ParameterSweep::getFrameCount() const { return frameCount; }
+
+SweepContainerSink::SweepContainerSink(const std::string &directory, const std::vector<SeaState> &seaStates, int resolution,
+                                       HeightfieldFormat format, bool withDisplacements, int firstFrame, int frameCount, float timeStep)
+    : directory(directory), seaStates(seaStates), resolution(resolution), format(format), withDisplacements(withDisplacements),
+      firstFrame(firstFrame), frameCount(frameCount), timeStep(timeStep)
+{
+}
+
+void SweepContainerSink::writeFrame(int frame, Span<float> heights, Span<const std::complex<float>> displacements)
+{
+    const int rank = frame / frameCount;
+    const int local = frame % frameCount;
+    std::unique_ptr<HeightfieldWriter> &container = open[rank];
+    if (!container)
+    {
+        const SeaState &state = seaStates.at(rank);
+        container.reset(new HeightfieldWriter(containerFileName(directory, state.index),
+                                              makeHeightfieldHeader(resolution, format, withDisplacements, state.seed, timeStep,
+                                                                    state.parameters)));
+    }
+
+    // Les frames d'un état arrivent dans l'ordre : la dernière ferme son fichier
+    const std::int64_t number = firstFrame + local;
+    container->appendFrame(number, static_cast<double>(number) * timeStep, heights, displacements);
+    if (local == frameCount - 1)
+    {
+        container->close();
+        open.erase(rank);
+    }
+}
+
+std::string SweepContainerSink::containerFileName(const std::string &directory, int seaState)
+{
+    std::ostringstream name;
+    if (!directory.empty())
+        name << directory << '/';
+    name << "seastate_" << std::setfill('0') << std::setw(6) << seaState << ".hf";
+    return name.str();
+}
@@ -0,0 +1,85 @@
+#ifndef PARAMETERSWEEP_H
+#define PARAMETERSWEEP_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "BatchWriter.hh"
+#include "HeightfieldFile.hh"
+#include "heightmap.hh"
+
+// Un état de mer du balayage : ses paramètres et la graine de son spectre
+struct SeaState
+{
+    int index = 0; // Rang dans le balayage complet, donne le nom du fichier
+    unsigned seed = 0;
+    OceanParameters parameters;
+};
+
+// Grille régulière sur les intervalles [MIN, MAX] : windSpeeds x directions x
+// choppinesses x patchSizes états. Un axe à un seul point garde la valeur de
+// la compilation ; les directions font le tour complet. L'état i a la graine seed + i.
+std::vector<SeaState> sweepGrid(int windSpeeds, int directions, int choppinesses, int patchSizes, unsigned seed);
+// count états tirés uniformément sur les mêmes intervalles, reproductibles pour une graine
+std::vector<SeaState> sweepRandom(int count, unsigned seed);
+
+struct SweepStats
+{
+    int seaStates = 0;
+    long long frames = 0;
+    double seconds = 0;
+    double framesPerSecond = 0; // Frames d'états de mer par seconde
+};
+
+// Simulation de nombreux états de mer indépendants. Les états sont répartis
+// entre les threads du pool un par un, au fil de l'eau : un thread qui a fini
+// prend le suivant, quel que soit le coût des autres. Chaque état est calculé
+// en entier par un seul thread (les parallelFor imbriqués s'exécutent en
+// série) dans un OceanStateF réservé à ce thread : la mémoire de calcul est
+// bornée à un état par thread, et celle des frames en attente aux tampons du
+// BatchWriter.
+class ParameterSweep
+{
+private:
+    int resolution;
+    int firstFrame;
+    int frameCount;
+    float timeStep;
+
+public:
+    // Frames [firstFrame, firstFrame + frameCount) de chaque état, la frame i à t = i * timeStep
+    ParameterSweep(int resolution, int firstFrame, int frameCount, float timeStep);
+
+    // Les frames sont poussées dans writer avec le numéro rang * frameCount + i,
+    // rang étant la position de l'état dans seaStates (voir SweepContainerSink),
+    // puis run attend leur écriture
+    SweepStats run(const std::vector<SeaState> &seaStates, BatchWriter &writer) const;
+
+    int getFrameCount() const;
+};
+
+// Un conteneur par état de mer, seastate_XXXXXX.hf, dont l'en-tête porte ses
+// paramètres. Au plus un fichier ouvert par état en cours de calcul.
+class SweepContainerSink : public FrameSink
+{
+private:
+    std::string directory;
+    const std::vector<SeaState> &seaStates;
+    int resolution;
+    HeightfieldFormat format;
+    bool withDisplacements;
+    int firstFrame;
+    int frameCount;
+    float timeStep;
+    std::map<int, std::unique_ptr<HeightfieldWriter>> open;
+
+public:
+    SweepContainerSink(const std::string &directory, const std::vector<SeaState> &seaStates, int resolution, HeightfieldFormat format,
+                       bool withDisplacements, int firstFrame, int frameCount, float timeStep);
+    void writeFrame(int frame, Span<float> heights, Span<const std::complex<float>> displacements) override;
+
+    static std::string containerFileName(const std::string &directory, int seaState);
+};
+
+#endif // PARAMETERSWEEP_H
@@ -0,0 +1,41 @@
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <cstdint>
+
+// Générateur à compteur Philox4x32-10 (Salmon et al., "Parallel Random Numbers:
+// As Easy as 1, 2, 3", 2011) : chaque bloc de quatre entiers ne dépend que du
+// compteur et de la clé, on peut donc tirer n'importe quelle cellule dans
+// n'importe quel ordre et sur n'importe quel thread.
+
+constexpr std::uint32_t PHILOX_M0 = 0xD2511F53;
+constexpr std::uint32_t PHILOX_M1 = 0xCD9E8D57;
+constexpr std::uint32_t PHILOX_W0 = 0x9E3779B9;
+constexpr std::uint32_t PHILOX_W1 = 0xBB67AE85;
+constexpr int PHILOX_ROUNDS = 10;
+
+struct PhiloxBlock
+{
+    std::uint32_t v[4];
+};
+
+inline PhiloxBlock philox4x32(std::uint32_t c0, std::uint32_t c1, std::uint32_t c2, std::uint32_t c3,
+                              std::uint32_t k0, std::uint32_t k1)
+{
+    for (int round = 0; round < PHILOX_ROUNDS; ++round)
+    {
+        const std::uint64_t p0 = static_cast<std::uint64_t>(PHILOX_M0) * c0;
+        const std::uint64_t p1 = static_cast<std::uint64_t>(PHILOX_M1) * c2;
+        const std::uint32_t hi0 = static_cast<std::uint32_t>(p0 >> 32);
+        const std::uint32_t hi1 = static_cast<std::uint32_t>(p1 >> 32);
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = static_cast<std::uint32_t>(p1);
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = static_cast<std::uint32_t>(p0);
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    return PhiloxBlock{{c0, c1, c2, c3}};
+}
+
+#endif // PHILOX_H
@@ -0,0 +1,279 @@
+#include "Profiler.hh"
+
+#ifdef OCEAN_PROFILING
+
+#include "AllocationCounter.hh"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace
+{
+    // Histogramme log-linéaire : valeurs < 16 exactes, puis 16 sous-intervalles
+    // par puissance de deux (erreur relative < 6,25 %), jusqu'à 2^48 ns
+    const int SUB_BUCKET_BITS = 4;
+    const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    const int MAX_MAGNITUDE = 48;
+    const int BUCKET_COUNT = (MAX_MAGNITUDE - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+    const std::size_t RING_CAPACITY = 4096; // Événements récents gardés par thread
+
+    int bucketIndex(std::uint64_t value)
+    {
+        if (value < static_cast<std::uint64_t>(SUB_BUCKETS))
+            return static_cast<int>(value);
+        const int magnitude = std::min(63 - __builtin_clzll(value), MAX_MAGNITUDE);
+        const int shift = magnitude - SUB_BUCKET_BITS;
+        const int sub = static_cast<int>((value >> shift) & (SUB_BUCKETS - 1));
+        return std::min((shift + 1) * SUB_BUCKETS + sub, BUCKET_COUNT - 1);
+    }
+
+    // Borne haute des valeurs rangées dans bucket
+    std::uint64_t bucketUpperBound(int bucket)
+    {
+        if (bucket < SUB_BUCKETS)
+            return bucket;
+        const int shift = bucket / SUB_BUCKETS - 1;
+        const std::uint64_t sub = bucket % SUB_BUCKETS;
+        return ((SUB_BUCKETS + sub + 1) << shift) - 1;
+    }
+
+    struct Event
+    {
+        std::uint64_t frame;
+        std::uint64_t start;
+        std::uint64_t duration;
+        std::uint64_t allocations;
+        std::uint64_t bytes;
+        ProfileStage stage;
+    };
+
+    // Un seul écrivain (le thread propriétaire) : des load/store relaxed suffisent
+    template <typename T>
+    void relaxedAdd(std::atomic<T> &counter, T value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    struct StageStats
+    {
+        std::atomic<std::uint64_t> buckets[BUCKET_COUNT];
+        std::atomic<std::uint64_t> count;
+        std::atomic<std::uint64_t> total;
+        std::atomic<std::uint64_t> max;
+        std::atomic<std::uint64_t> allocations;
+        std::atomic<std::uint64_t> bytes;
+    };
+
+    struct ThreadLog
+    {
+        int id;
+        StageStats stages[STAGE_COUNT];
+        Event ring[RING_CAPACITY];
+        std::atomic<std::uint64_t> head; // Nombre total d'événements écrits
+
+        explicit ThreadLog(int id) : id(id), stages(), head(0) {}
+    };
+
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadLog>> registry; // Jamais réduit : les journaux survivent à leur thread
+
+    std::atomic<std::uint64_t> frameNumber(0);
+    std::atomic<std::uint64_t> lastFrameStart(0);
+    std::atomic<bool> dumpRequested(false);
+    std::string dumpPrefix;
+
+    ThreadLog &threadLog()
+    {
+        thread_local ThreadLog *log = nullptr;
+        if (!log)
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            registry.push_back(std::unique_ptr<ThreadLog>(new ThreadLog(static_cast<int>(registry.size()))));
+            log = registry.back().get();
+        }
+        return *log;
+    }
+
+    void requestDump(int)
+    {
+        dumpRequested.store(true, std::memory_order_relaxed);
+    }
+
+    void dumpAtExit()
+    {
+        Profiler::dumpFiles(dumpPrefix);
+    }
+
+    // Somme des histogrammes de tous les threads pour une étape
+    struct MergedStats
+    {
+        std::vector<std::uint64_t> buckets;
+        std::uint64_t count = 0;
+        std::uint64_t total = 0;
+        std::uint64_t max = 0;
+        std::uint64_t allocations = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    MergedStats merge(ProfileStage stage)
+    {
+        MergedStats merged;
+        merged.buckets.assign(BUCKET_COUNT, 0);
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const std::unique_ptr<ThreadLog> &log : registry)
+        {
+            const StageStats &stats = log->stages[stage];
+            for (int b = 0; b < BUCKET_COUNT; ++b)
+                merged.buckets[b] += stats.buckets[b].load(std::memory_order_relaxed);
+            merged.count += stats.count.load(std::memory_order_relaxed);
+            merged.total += stats.total.load(std::memory_order_relaxed);
+            merged.max = std::max(merged.max, stats.max.load(std::memory_order_relaxed));
+            merged.allocations += stats.allocations.load(std::memory_order_relaxed);
+            merged.bytes += stats.bytes.load(std::memory_order_relaxed);
+        }
+        return merged;
+    }
+
+    std::uint64_t percentile(const MergedStats &stats, double fraction)
+    {
+        const std::uint64_t rank = static_cast<std::uint64_t>(fraction * stats.count + 0.5);
+        std::uint64_t seen = 0;
+        for (int b = 0; b < BUCKET_COUNT; ++b)
+        {
+            seen += stats.buckets[b];
+            if (seen >= std::max<std::uint64_t>(rank, 1))
+                return std::min(bucketUpperBound(b), stats.max);
+        }
+        return stats.max;
+    }
+}
+
+namespace Profiler
+{
+    const char *stageName(ProfileStage stage)
+    {
+        static const char *const names[STAGE_COUNT] = {
+            "evolve", "ifft_pack", "ifft_rows", "ifft_transpose", "ifft_columns", "unpack", "cascades",
+            "normalize", "vertices", "handoff", "upload", "tiles", "draw", "swap", "binning", "raster", "frame"};
+        return names[stage];
+    }
+
+    std::uint64_t nowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void record(ProfileStage stage, std::uint64_t startNs, std::uint64_t durationNs, std::uint64_t allocations, std::uint64_t bytes)
+    {
+        ThreadLog &log = threadLog();
+        StageStats &stats = log.stages[stage];
+        relaxedAdd(stats.buckets[bucketIndex(durationNs)], std::uint64_t(1));
+        relaxedAdd(stats.count, std::uint64_t(1));
+        relaxedAdd(stats.total, durationNs);
+        relaxedAdd(stats.allocations, allocations);
+        relaxedAdd(stats.bytes, bytes);
+        if (durationNs > stats.max.load(std::memory_order_relaxed))
+            stats.max.store(durationNs, std::memory_order_relaxed);
+
+        const std::uint64_t head = log.head.load(std::memory_order_relaxed);
+        log.ring[head % RING_CAPACITY] = Event{frameNumber.load(std::memory_order_relaxed), startNs, durationNs, allocations, bytes, stage};
+        log.head.store(head + 1, std::memory_order_release);
+    }
+
+    void nextFrame()
+    {
+        const std::uint64_t now = nowNs();
+        const std::uint64_t previous = lastFrameStart.exchange(now, std::memory_order_relaxed);
+        if (previous != 0)
+            record(STAGE_FRAME, previous, now - previous, 0, 0);
+        frameNumber.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void dumpJSON(std::ostream &out)
+    {
+        out << "{\n  \"frames\": " << frameNumber.load() << ",\n  \"stages\": [\n";
+        bool first = true;
+        for (int s = 0; s < STAGE_COUNT; ++s)
+        {
+            const MergedStats stats = merge(static_cast<ProfileStage>(s));
+            if (stats.count == 0)
+                continue;
+            if (!first)
+                out << ",\n";
+            first = false;
+            out << "    {\"stage\": \"" << stageName(static_cast<ProfileStage>(s)) << "\", \"count\": " << stats.count
+                << ", \"mean_ns\": " << stats.total / stats.count << ", \"p50_ns\": " << percentile(stats, 0.5)
+                << ", \"p90_ns\": " << percentile(stats, 0.9) << ", \"p99_ns\": " << percentile(stats, 0.99)
+                << ", \"max_ns\": " << stats.max << ", \"allocations\": " << stats.allocations
+                << ", \"bytes\": " << stats.bytes << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    void dumpCSV(std::ostream &out)
+    {
+        out << "thread,frame,stage,start_ns,duration_ns,allocations,bytes\n";
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const std::unique_ptr<ThreadLog> &log : registry)
+        {
+            // Copie des événements encore présents dans l'anneau, puis rejet de
+            // ceux que le thread propriétaire a pu réécrire pendant la copie
+            const std::uint64_t head = log->head.load(std::memory_order_acquire);
+            const std::uint64_t first = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+            std::vector<Event> events;
+            events.reserve(head - first);
+            for (std::uint64_t i = first; i < head; ++i)
+                events.push_back(log->ring[i % RING_CAPACITY]);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const std::uint64_t after = log->head.load(std::memory_order_relaxed);
+            const std::uint64_t overwritten = after > RING_CAPACITY + first ? after - RING_CAPACITY - first : 0;
+
+            for (std::size_t i = std::min<std::uint64_t>(overwritten, events.size()); i < events.size(); ++i)
+            {
+                const Event &e = events[i];
+                out << log->id << ',' << e.frame << ',' << stageName(e.stage) << ',' << e.start << ','
+                    << e.duration << ',' << e.allocations << ',' << e.bytes << '\n';
+            }
+        }
+    }
+
+    void dumpFiles(const std::string &prefix)
+    {
+        std::ofstream json(prefix + ".json");
+        dumpJSON(json);
+        std::ofstream csv(prefix + ".csv");
+        dumpCSV(csv);
+    }
+
+    void install(const std::string &prefix)
+    {
+        dumpPrefix = prefix;
+        std::atexit(dumpAtExit);
+        std::signal(SIGUSR1, requestDump);
+    }
+
+    void poll()
+    {
+        if (dumpRequested.exchange(false, std::memory_order_relaxed))
+            dumpFiles(dumpPrefix);
+    }
+}
+
+ProfileScope::ProfileScope(ProfileStage stage, std::uint64_t bytes)
+    : stage(stage), bytes(bytes), start(Profiler::nowNs()), allocations(threadAllocationCount())
+{
+}
+
+ProfileScope::~ProfileScope()
+{
+    Profiler::record(stage, start, Profiler::nowNs() - start, threadAllocationCount() - allocations, bytes);
+}
+
+#endif // OCEAN_PROFILING
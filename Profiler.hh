@@ -0,0 +1,97 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+// Instrumentation par étape du calcul et du rendu d'une frame.
+// Compilée seulement avec -DOCEAN_PROFILING (et AllocationCounter.cpp lié) :
+// sans ce drapeau, les macros OCEAN_PROFILE_* ne génèrent aucun code.
+//
+// Chaque thread enregistre ses mesures dans son propre journal (anneau
+// d'événements récents et histogrammes log-linéaires par étape), sans verrou :
+// seul le thread propriétaire écrit, la lecture pour l'export est concurrente.
+// OCEAN_PROFILE_INIT(prefix) écrit prefix.json (histogrammes) et prefix.csv
+// (événements récents) à la sortie du programme, ou à la réception de SIGUSR1
+// au prochain OCEAN_PROFILE_POLL().
+
+enum ProfileStage
+{
+    STAGE_EVOLVE,         // Évolution des spectres
+    STAGE_IFFT_PACK,      // Empaquetage des deux spectres pour l'IFFT groupée
+    STAGE_IFFT_ROWS,      // IFFT des lignes
+    STAGE_IFFT_TRANSPOSE, // Transposition par tuiles
+    STAGE_IFFT_COLUMNS,   // IFFT des colonnes (après transposition)
+    STAGE_UNPACK,         // Dépliage des hauteurs et du jacobien
+    STAGE_CASCADES,       // Somme des cascades sur la grille de la plus grande
+    STAGE_NORMALIZE,
+    STAGE_VERTICES,
+    STAGE_HANDOFF,        // Publication d'une frame simulée -> acquisition par le rendu
+    STAGE_UPLOAD,         // Envoi des sommets de la frame au GPU
+    STAGE_TILES,          // Choix des tuiles, niveaux de détail et frustum
+    STAGE_DRAW,           // Soumission des primitives OpenGL
+    STAGE_SWAP,
+    STAGE_BINNING,        // Rendu logiciel : projection, découpage et tri des triangles par tuile
+    STAGE_RASTER,         // Rendu logiciel : rastérisation et éclairage des tuiles
+    STAGE_FRAME,          // Intervalle entre deux OCEAN_PROFILE_FRAME()
+    STAGE_COUNT
+};
+
+#ifdef OCEAN_PROFILING
+
+namespace Profiler
+{
+    const char *stageName(ProfileStage stage);
+
+    std::uint64_t nowNs();
+    // Enregistre une mesure dans le journal du thread appelant
+    void record(ProfileStage stage, std::uint64_t startNs, std::uint64_t durationNs, std::uint64_t allocations, std::uint64_t bytes);
+    void nextFrame();
+
+    void dumpJSON(std::ostream &out);
+    void dumpCSV(std::ostream &out);
+    void dumpFiles(const std::string &prefix);
+
+    void install(const std::string &prefix); // Export à la sortie et sur SIGUSR1
+    void poll();                             // Effectue l'export demandé par SIGUSR1
+}
+
+// Mesure la durée de vie de l'objet, et les allocations du thread pendant ce temps
+class ProfileScope
+{
+private:
+    ProfileStage stage;
+    std::uint64_t bytes;
+    std::uint64_t start;
+    std::uint64_t allocations;
+
+public:
+    ProfileScope(ProfileStage stage, std::uint64_t bytes = 0);
+    ~ProfileScope();
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+};
+
+#define OCEAN_PROFILE_CONCAT_(a, b) a##b
+#define OCEAN_PROFILE_CONCAT(a, b) OCEAN_PROFILE_CONCAT_(a, b)
+#define OCEAN_PROFILE_SCOPE(stage) ProfileScope OCEAN_PROFILE_CONCAT(profileScope, __LINE__)(stage)
+#define OCEAN_PROFILE_SCOPE_BYTES(stage, bytes) ProfileScope OCEAN_PROFILE_CONCAT(profileScope, __LINE__)(stage, bytes)
+// Durée mesurée ailleurs (par exemple entre deux threads), sur l'horloge de Profiler::nowNs
+#define OCEAN_PROFILE_RECORD(stage, startNs, durationNs) Profiler::record(stage, startNs, durationNs, 0, 0)
+#define OCEAN_PROFILE_FRAME() Profiler::nextFrame()
+#define OCEAN_PROFILE_INIT(prefix) Profiler::install(prefix)
+#define OCEAN_PROFILE_POLL() Profiler::poll()
+
+#else
+
+#define OCEAN_PROFILE_SCOPE(stage) ((void)0)
+#define OCEAN_PROFILE_SCOPE_BYTES(stage, bytes) ((void)0)
+#define OCEAN_PROFILE_RECORD(stage, startNs, durationNs) ((void)0)
+#define OCEAN_PROFILE_FRAME() ((void)0)
+#define OCEAN_PROFILE_INIT(prefix) ((void)0)
+#define OCEAN_PROFILE_POLL() ((void)0)
+
+#endif // OCEAN_PROFILING
+
+#endif // PROFILER_H
@@ -0,0 +1,47 @@
+#ifndef RESOLUTION_H
+#define RESOLUTION_H
+
+#include <stdexcept>
+#include <type_traits>
+
+// La résolution de la grille est choisie au démarrage parmi les puissances de
+// deux de MIN_RESOLUTION à MAX_RESOLUTION.
+constexpr int DEFAULT_RESOLUTION = 128;
+constexpr int MIN_RESOLUTION = 64;
+constexpr int MAX_RESOLUTION = 2048;
+
+inline bool isSupportedResolution(int resolution)
+{
+    return resolution >= MIN_RESOLUTION && resolution <= MAX_RESOLUTION && (resolution & (resolution - 1)) == 0;
+}
+
+// Appelle fn(std::integral_constant<int, N>()) pour N == resolution : les noyaux
+// sont instanciés pour chaque taille supportée et gardent des bornes de boucle constantes.
+template <typename Fn>
+void dispatchResolution(int resolution, Fn &&fn)
+{
+    switch (resolution)
+    {
+    case 64:
+        fn(std::integral_constant<int, 64>());
+        return;
+    case 128:
+        fn(std::integral_constant<int, 128>());
+        return;
+    case 256:
+        fn(std::integral_constant<int, 256>());
+        return;
+    case 512:
+        fn(std::integral_constant<int, 512>());
+        return;
+    case 1024:
+        fn(std::integral_constant<int, 1024>());
+        return;
+    case 2048:
+        fn(std::integral_constant<int, 2048>());
+        return;
+    }
+    throw std::invalid_argument("Résolution non supportée : puissance de deux entre 64 et 2048 attendue");
+}
+
+#endif // RESOLUTION_H
@@ -0,0 +1,758 @@
+#include "SimdKernels.hh"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define OCEAN_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    typedef void (*Radix4PassFn)(ComplexF *, int, int, const ComplexF *, const ComplexF *);
+    typedef void (*EvolveSpectrumFn)(float, std::size_t, const ComplexF *, const ComplexF *, const float *, const ComplexF *, const ComplexF *, const SpectralFieldsF &);
+    typedef void (*EvolveRotorFn)(std::size_t, const ComplexF *, const ComplexF *, ComplexF *, const ComplexF *, const ComplexF *, const ComplexF *, const SpectralFieldsF &);
+    typedef void (*GaussianRowFn)(std::uint32_t, std::uint32_t, std::uint32_t, std::size_t, ComplexF *);
+    typedef void (*AbsMinMaxFn)(const float *, std::size_t, float &, float &);
+    typedef void (*ScaleAbsFn)(float *, std::size_t, float, float);
+    typedef void (*SampleSurfaceFn)(const SurfaceFieldsF &, SampleFilter, int, std::size_t, const float *, const float *, float *, float *, float *);
+    typedef void (*EvaluateModesFn)(const ModeSetF &, std::size_t, const float *, const float *, float *, float *, float *);
+    typedef void (*RasterTriangleFn)(const RasterTriangleF &, std::uint32_t, const RasterTargetF &, int, int, int, int);
+
+    struct KernelTable
+    {
+        const char *name;
+        Radix4PassFn radix4Pass;
+        EvolveSpectrumFn evolveSpectrum;
+        EvolveRotorFn evolveRotor;
+        GaussianRowFn gaussianRow;
+        AbsMinMaxFn absMinMax;
+        ScaleAbsFn scaleAbs;
+        SampleSurfaceFn sampleSurface;
+        EvaluateModesFn evaluateModes;
+        RasterTriangleFn rasterTriangle;
+    };
+
+    void radix4PassScalar(ComplexF *data, int n, int half, const ComplexF *w1, const ComplexF *w2)
+    {
+        radix4PassKernel<float>(data, n, half, w1, w2);
+    }
+
+    void evolveSpectrumScalar(float t, std::size_t count, const ComplexF *h0, const ComplexF *h0Mirror, const float *omega,
+                              const ComplexF *directions, const ComplexF *waveVectors, const SpectralFieldsF &out)
+    {
+        evolveSpectrumKernel<float>(t, count, h0, h0Mirror, omega, directions, waveVectors, out);
+    }
+
+    void evolveRotorScalar(std::size_t count, const ComplexF *h0, const ComplexF *h0Mirror, ComplexF *phases, const ComplexF *rotors,
+                           const ComplexF *directions, const ComplexF *waveVectors, const SpectralFieldsF &out)
+    {
+        evolveRotorKernel<float>(count, h0, h0Mirror, phases, rotors, directions, waveVectors, out);
+    }
+
+    // Les mêmes sorties décalées de offset cellules
+    SpectralFieldsF offsetFields(const SpectralFieldsF &out, std::size_t offset)
+    {
+        return SpectralFieldsF{out.heights + offset, out.displacements + offset, out.slopes + offset, out.jacobian + offset};
+    }
+
+    void gaussianRowScalar(std::uint32_t seed, std::uint32_t row, std::uint32_t first, std::size_t count, ComplexF *out)
+    {
+        gaussianRowKernel<float>(seed, row, first, count, out);
+    }
+
+    void absMinMaxScalar(const float *values, std::size_t count, float &min, float &max)
+    {
+        absMinMaxKernel<float>(values, count, min, max);
+    }
+
+    void scaleAbsScalar(float *values, std::size_t count, float scale, float offset)
+    {
+        scaleAbsKernel<float>(values, count, scale, offset);
+    }
+
+    void sampleSurfaceScalar(const SurfaceFieldsF &surface, SampleFilter filter, int iterations, std::size_t count,
+                             const float *x, const float *z, float *heights, float *displacementX, float *displacementZ)
+    {
+        sampleSurfaceKernel<float>(surface, filter, iterations, count, x, z, heights, displacementX, displacementZ);
+    }
+
+    void evaluateModesScalar(const ModeSetF &modes, std::size_t count, const float *x, const float *z, float *heights,
+                             float *displacementX, float *displacementZ)
+    {
+        evaluateModesKernel<float>(modes, count, x, z, heights, displacementX, displacementZ);
+    }
+
+    void rasterTriangleScalar(const RasterTriangleF &triangle, std::uint32_t id, const RasterTargetF &target, int x0, int y0, int x1, int y1)
+    {
+        rasterTriangleKernel<float>(triangle, id, target, x0, y0, x1, y1);
+    }
+
+#ifdef OCEAN_X86_DISPATCH
+
+    // ---- SSE3 : 2 complexes float par registre ----
+
+    __attribute__((target("sse3"))) inline __m128 complexMul128(__m128 a, __m128 w)
+    {
+        const __m128 wr = _mm_moveldup_ps(w);
+        const __m128 wi = _mm_movehdup_ps(w);
+        const __m128 swapped = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1));
+        return _mm_addsub_ps(_mm_mul_ps(a, wr), _mm_mul_ps(swapped, wi));
+    }
+
+    __attribute__((target("sse3"))) inline __m128 mulI128(__m128 a)
+    {
+        const __m128 swapped = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1));
+        return _mm_xor_ps(swapped, _mm_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f));
+    }
+
+    __attribute__((target("sse3"))) void radix4PassSse(ComplexF *data, int n, int half, const ComplexF *w1, const ComplexF *w2)
+    {
+        if (half < 2)
+        {
+            radix4PassScalar(data, n, half, w1, w2);
+            return;
+        }
+
+        float *d = reinterpret_cast<float *>(data);
+        const float *pw1 = reinterpret_cast<const float *>(w1);
+        const float *pw2 = reinterpret_cast<const float *>(w2);
+        for (int b = 0; b < n; b += 4 * half)
+        {
+            for (int k = 0; k < half; k += 2)
+            {
+                const __m128 tw1 = _mm_loadu_ps(pw1 + 2 * k);
+                const __m128 tw2 = _mm_loadu_ps(pw2 + 2 * k);
+                float *p0 = d + 2 * (b + k);
+                float *p1 = p0 + 2 * half;
+                float *p2 = p1 + 2 * half;
+                float *p3 = p2 + 2 * half;
+
+                const __m128 a0 = _mm_loadu_ps(p0);
+                const __m128 a1 = complexMul128(_mm_loadu_ps(p1), tw1);
+                const __m128 a2 = _mm_loadu_ps(p2);
+                const __m128 a3 = complexMul128(_mm_loadu_ps(p3), tw1);
+
+                const __m128 t0 = _mm_add_ps(a0, a1);
+                const __m128 t1 = _mm_sub_ps(a0, a1);
+                const __m128 t2 = complexMul128(_mm_add_ps(a2, a3), tw2);
+                const __m128 t3i = mulI128(complexMul128(_mm_sub_ps(a2, a3), tw2));
+
+                _mm_storeu_ps(p0, _mm_add_ps(t0, t2));
+                _mm_storeu_ps(p2, _mm_sub_ps(t0, t2));
+                _mm_storeu_ps(p1, _mm_add_ps(t1, t3i));
+                _mm_storeu_ps(p3, _mm_sub_ps(t1, t3i));
+            }
+        }
+    }
+
+    __attribute__((target("sse3"))) void absMinMaxSse(const float *values, std::size_t count, float &min, float &max)
+    {
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        __m128 vmin = _mm_set1_ps(min);
+        __m128 vmax = _mm_set1_ps(max);
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 v = _mm_andnot_ps(signMask, _mm_loadu_ps(values + i));
+            vmin = _mm_min_ps(vmin, v);
+            vmax = _mm_max_ps(vmax, v);
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, vmin);
+        for (float lane : lanes)
+            min = lane < min ? lane : min;
+        _mm_storeu_ps(lanes, vmax);
+        for (float lane : lanes)
+            max = lane > max ? lane : max;
+        absMinMaxScalar(values + i, count - i, min, max);
+    }
+
+    __attribute__((target("sse3"))) void scaleAbsSse(float *values, std::size_t count, float scale, float offset)
+    {
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        const __m128 vscale = _mm_set1_ps(scale);
+        const __m128 voffset = _mm_set1_ps(offset);
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 v = _mm_andnot_ps(signMask, _mm_loadu_ps(values + i));
+            _mm_storeu_ps(values + i, _mm_add_ps(_mm_mul_ps(v, vscale), voffset));
+        }
+        scaleAbsScalar(values + i, count - i, scale, offset);
+    }
+
+    // ---- AVX2 + FMA : 4 complexes float par registre ----
+
+    __attribute__((target("avx2,fma"))) inline __m256 complexMul256(__m256 a, __m256 w)
+    {
+        const __m256 wr = _mm256_moveldup_ps(w);
+        const __m256 wi = _mm256_movehdup_ps(w);
+        const __m256 swapped = _mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1));
+        return _mm256_fmaddsub_ps(a, wr, _mm256_mul_ps(swapped, wi));
+    }
+
+    __attribute__((target("avx2,fma"))) inline __m256 mulI256(__m256 a)
+    {
+        const __m256 swapped = _mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1));
+        return _mm256_xor_ps(swapped, _mm256_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f));
+    }
+
+    // sin et cos simultanés sur 8 floats (polynômes de Cephes, réduction de Cody-Waite sur π/2)
+    __attribute__((target("avx2,fma"))) inline void sinCos256(__m256 x, __m256 &s, __m256 &c)
+    {
+        const __m256 q = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(0.63661977236758134f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256 r = _mm256_fnmadd_ps(q, _mm256_set1_ps(1.5703125f), x);
+        r = _mm256_fnmadd_ps(q, _mm256_set1_ps(4.837512969970703125e-4f), r);
+        r = _mm256_fnmadd_ps(q, _mm256_set1_ps(7.54978995489188216e-8f), r);
+
+        const __m256 r2 = _mm256_mul_ps(r, r);
+        __m256 ps = _mm256_fmadd_ps(_mm256_set1_ps(-1.9515295891e-4f), r2, _mm256_set1_ps(8.3321608736e-3f));
+        ps = _mm256_fmadd_ps(ps, r2, _mm256_set1_ps(-1.6666654611e-1f));
+        ps = _mm256_fmadd_ps(_mm256_mul_ps(ps, r2), r, r);
+
+        __m256 pc = _mm256_fmadd_ps(_mm256_set1_ps(2.443315711809948e-5f), r2, _mm256_set1_ps(-1.388731625493765e-3f));
+        pc = _mm256_fmadd_ps(pc, r2, _mm256_set1_ps(4.166664568298827e-2f));
+        pc = _mm256_fmadd_ps(_mm256_mul_ps(pc, r2), r2, _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), r2, _mm256_set1_ps(1.0f)));
+
+        // Quadrant : échange sin/cos si impair, puis signes
+        const __m256i qi = _mm256_cvtps_epi32(q);
+        const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(qi, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+        const __m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(qi, _mm256_set1_epi32(2)), 30));
+        const __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(qi, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+
+        s = _mm256_xor_ps(_mm256_blendv_ps(ps, pc, swap), sinSign);
+        c = _mm256_xor_ps(_mm256_blendv_ps(pc, ps, swap), cosSign);
+    }
+
+    __attribute__((target("avx2,fma"))) void radix4PassAvx2(ComplexF *data, int n, int half, const ComplexF *w1, const ComplexF *w2)
+    {
+        if (half < 4)
+        {
+            radix4PassSse(data, n, half, w1, w2);
+            return;
+        }
+
+        float *d = reinterpret_cast<float *>(data);
+        const float *pw1 = reinterpret_cast<const float *>(w1);
+        const float *pw2 = reinterpret_cast<const float *>(w2);
+        for (int b = 0; b < n; b += 4 * half)
+        {
+            for (int k = 0; k < half; k += 4)
+            {
+                const __m256 tw1 = _mm256_loadu_ps(pw1 + 2 * k);
+                const __m256 tw2 = _mm256_loadu_ps(pw2 + 2 * k);
+                float *p0 = d + 2 * (b + k);
+                float *p1 = p0 + 2 * half;
+                float *p2 = p1 + 2 * half;
+                float *p3 = p2 + 2 * half;
+
+                const __m256 a0 = _mm256_loadu_ps(p0);
+                const __m256 a1 = complexMul256(_mm256_loadu_ps(p1), tw1);
+                const __m256 a2 = _mm256_loadu_ps(p2);
+                const __m256 a3 = complexMul256(_mm256_loadu_ps(p3), tw1);
+
+                const __m256 t0 = _mm256_add_ps(a0, a1);
+                const __m256 t1 = _mm256_sub_ps(a0, a1);
+                const __m256 t2 = complexMul256(_mm256_add_ps(a2, a3), tw2);
+                const __m256 t3i = mulI256(complexMul256(_mm256_sub_ps(a2, a3), tw2));
+
+                _mm256_storeu_ps(p0, _mm256_add_ps(t0, t2));
+                _mm256_storeu_ps(p2, _mm256_sub_ps(t0, t2));
+                _mm256_storeu_ps(p1, _mm256_add_ps(t1, t3i));
+                _mm256_storeu_ps(p3, _mm256_sub_ps(t1, t3i));
+            }
+        }
+    }
+
+    // Les quatre spectres de 4 cellules à partir de h(k, t) (voir storeSpectralFields)
+    __attribute__((target("avx2,fma"))) inline void storeSpectralFields256(__m256 spec, const ComplexF *directions, const ComplexF *waveVectors,
+                                                                          const SpectralFieldsF &out, std::size_t i)
+    {
+        const __m256 negate = _mm256_set1_ps(-0.0f);
+        const __m256 dir = _mm256_loadu_ps(reinterpret_cast<const float *>(directions + i));
+        const __m256 k = _mm256_loadu_ps(reinterpret_cast<const float *>(waveVectors + i));
+        // h (1 - i kx dz) = h - i h (kx dz)
+        const __m256 crossTerm = _mm256_mul_ps(_mm256_moveldup_ps(k), _mm256_movehdup_ps(dir));
+        const __m256 heights = _mm256_fnmadd_ps(mulI256(spec), crossTerm, spec);
+        // -i * direction * spec et -i * k * spec
+        const __m256 displacements = _mm256_xor_ps(mulI256(complexMul256(spec, dir)), negate);
+        const __m256 slopes = _mm256_xor_ps(mulI256(complexMul256(spec, k)), negate);
+        // -(kx dx + i kz dz) * spec
+        const __m256 jacobian = _mm256_xor_ps(complexMul256(spec, _mm256_mul_ps(k, dir)), negate);
+
+        _mm256_storeu_ps(reinterpret_cast<float *>(out.heights + i), heights);
+        _mm256_storeu_ps(reinterpret_cast<float *>(out.displacements + i), displacements);
+        _mm256_storeu_ps(reinterpret_cast<float *>(out.slopes + i), slopes);
+        _mm256_storeu_ps(reinterpret_cast<float *>(out.jacobian + i), jacobian);
+    }
+
+    __attribute__((target("avx2,fma"))) void evolveSpectrumAvx2(float t, std::size_t count, const ComplexF *h0, const ComplexF *h0Mirror, const float *omega,
+                                                               const ComplexF *directions, const ComplexF *waveVectors, const SpectralFieldsF &out)
+    {
+        const __m256 vt = _mm256_set1_ps(t);
+        std::size_t i = 0;
+        // 8 cellules par itération : un sinCos256, puis deux moitiés de 4 complexes
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256 s, c;
+            sinCos256(_mm256_mul_ps(_mm256_loadu_ps(omega + i), vt), s, c);
+
+            // [c0 c0 c1 c1 c2 c2 c3 c3] et [c4 c4 ... c7 c7]
+            const __m256 cLo = _mm256_unpacklo_ps(c, c);
+            const __m256 cHi = _mm256_unpackhi_ps(c, c);
+            const __m256 sLo = _mm256_unpacklo_ps(s, s);
+            const __m256 sHi = _mm256_unpackhi_ps(s, s);
+            const __m256 cs[2][2] = {
+                {_mm256_permute2f128_ps(cLo, cHi, 0x20), _mm256_permute2f128_ps(sLo, sHi, 0x20)},
+                {_mm256_permute2f128_ps(cLo, cHi, 0x31), _mm256_permute2f128_ps(sLo, sHi, 0x31)}};
+
+            for (int part = 0; part < 2; ++part)
+            {
+                const std::size_t j = i + 4 * part;
+                const __m256 a = _mm256_loadu_ps(reinterpret_cast<const float *>(h0 + j));
+                const __m256 m = _mm256_loadu_ps(reinterpret_cast<const float *>(h0Mirror + j));
+                // h0 e + m conj(e) = (h0 + m) cos + i (h0 - m) sin
+                const __m256 sum = _mm256_add_ps(a, m);
+                const __m256 diff = mulI256(_mm256_sub_ps(a, m));
+                const __m256 spec = _mm256_fmadd_ps(sum, cs[part][0], _mm256_mul_ps(diff, cs[part][1]));
+                storeSpectralFields256(spec, directions, waveVectors, out, j);
+            }
+        }
+        evolveSpectrumScalar(t, count - i, h0 + i, h0Mirror + i, omega + i, directions + i, waveVectors + i, offsetFields(out, i));
+    }
+
+    __attribute__((target("avx2,fma"))) void evolveRotorAvx2(std::size_t count, const ComplexF *h0, const ComplexF *h0Mirror, ComplexF *phases, const ComplexF *rotors,
+                                                            const ComplexF *directions, const ComplexF *waveVectors, const SpectralFieldsF &out)
+    {
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            float *p = reinterpret_cast<float *>(phases + i);
+            const __m256 e = _mm256_loadu_ps(p);
+            const __m256 a = _mm256_loadu_ps(reinterpret_cast<const float *>(h0 + i));
+            const __m256 m = _mm256_loadu_ps(reinterpret_cast<const float *>(h0Mirror + i));
+            // h0 e + m conj(e) = (h0 + m) Re(e) + i (h0 - m) Im(e)
+            const __m256 sum = _mm256_add_ps(a, m);
+            const __m256 diff = mulI256(_mm256_sub_ps(a, m));
+            const __m256 spec = _mm256_fmadd_ps(sum, _mm256_moveldup_ps(e), _mm256_mul_ps(diff, _mm256_movehdup_ps(e)));
+            storeSpectralFields256(spec, directions, waveVectors, out, i);
+            _mm256_storeu_ps(p, complexMul256(e, _mm256_loadu_ps(reinterpret_cast<const float *>(rotors + i))));
+        }
+        evolveRotorScalar(count - i, h0 + i, h0Mirror + i, phases + i, rotors + i, directions + i, waveVectors + i, offsetFields(out, i));
+    }
+
+    // Partie haute des produits 32 x 32 bits, voie par voie
+    __attribute__((target("avx2,fma"))) inline __m256i mulHi256(__m256i a, __m256i m)
+    {
+        const __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(a, m), 32);
+        const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+        return _mm256_blend_epi32(even, odd, 0xAA);
+    }
+
+    // log(x) pour x > 0 normalisé (polynôme de Cephes, comme sinCos256)
+    __attribute__((target("avx2,fma"))) inline __m256 log256(__m256 x)
+    {
+        const __m256i bits = _mm256_castps_si256(x);
+        __m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+        // Mantisse ramenée dans [0.5, 1)
+        __m256 m = _mm256_or_ps(_mm256_castsi256_ps(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff))), _mm256_set1_ps(0.5f));
+
+        // m < sqrt(1/2) : m = 2m - 1 et e -= 1, sinon m = m - 1
+        const __m256 small = _mm256_cmp_ps(m, _mm256_set1_ps(0.707106781186547524f), _CMP_LT_OQ);
+        e = _mm256_sub_ps(e, _mm256_and_ps(small, _mm256_set1_ps(1.0f)));
+        m = _mm256_add_ps(_mm256_sub_ps(m, _mm256_set1_ps(1.0f)), _mm256_and_ps(small, m));
+
+        const __m256 z = _mm256_mul_ps(m, m);
+        __m256 y = _mm256_fmadd_ps(_mm256_set1_ps(7.0376836292e-2f), m, _mm256_set1_ps(-1.1514610310e-1f));
+        y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(1.1676998740e-1f));
+        y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(-1.2420140846e-1f));
+        y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(1.4249322787e-1f));
+        y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(-1.6668057665e-1f));
+        y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(2.0000714765e-1f));
+        y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(-2.4999993993e-1f));
+        y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(3.3333331174e-1f));
+        y = _mm256_mul_ps(_mm256_mul_ps(y, m), z);
+
+        y = _mm256_fmadd_ps(e, _mm256_set1_ps(-2.12194440e-4f), y);
+        y = _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, y);
+        return _mm256_fmadd_ps(e, _mm256_set1_ps(0.693359375f), _mm256_add_ps(m, y));
+    }
+
+    __attribute__((target("avx2,fma"))) void gaussianRowAvx2(std::uint32_t seed, std::uint32_t row, std::uint32_t first, std::size_t count, ComplexF *out)
+    {
+        const __m256i m0 = _mm256_set1_epi32(static_cast<int>(PHILOX_M0));
+        const __m256i m1 = _mm256_set1_epi32(static_cast<int>(PHILOX_M1));
+        std::size_t i = 0;
+        // 8 cellules par itération : 8 blocs Philox en parallèle sur les voies 32 bits
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i c0 = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(first + i)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+            __m256i c1 = _mm256_set1_epi32(static_cast<int>(row));
+            __m256i c2 = _mm256_setzero_si256();
+            __m256i c3 = _mm256_setzero_si256();
+            std::uint32_t k0 = seed;
+            std::uint32_t k1 = 0;
+            for (int round = 0; round < PHILOX_ROUNDS; ++round)
+            {
+                const __m256i hi0 = mulHi256(c0, m0);
+                const __m256i hi1 = mulHi256(c2, m1);
+                const __m256i lo0 = _mm256_mullo_epi32(c0, m0);
+                const __m256i lo1 = _mm256_mullo_epi32(c2, m1);
+                c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32(static_cast<int>(k0)));
+                c1 = lo1;
+                c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32(static_cast<int>(k1)));
+                c3 = lo0;
+                k0 += PHILOX_W0;
+                k1 += PHILOX_W1;
+            }
+
+            const __m256 scale = _mm256_set1_ps(1.0f / 16777216.0f);
+            const __m256 u1 = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_srli_epi32(c0, 8), _mm256_set1_epi32(1))), scale);
+            const __m256 u2 = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(c1, 8)), scale);
+            const __m256 radius = _mm256_sqrt_ps(_mm256_mul_ps(_mm256_set1_ps(-2.0f), log256(u1)));
+            __m256 s, c;
+            sinCos256(_mm256_mul_ps(u2, _mm256_set1_ps(6.283185307179586f)), s, c);
+            const __m256 re = _mm256_mul_ps(radius, c);
+            const __m256 im = _mm256_mul_ps(radius, s);
+
+            // Entrelacement (re, im) des 8 complexes
+            const __m256 lo = _mm256_unpacklo_ps(re, im);
+            const __m256 hi = _mm256_unpackhi_ps(re, im);
+            float *o = reinterpret_cast<float *>(out + i);
+            _mm256_storeu_ps(o, _mm256_permute2f128_ps(lo, hi, 0x20));
+            _mm256_storeu_ps(o + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+        }
+        gaussianRowScalar(seed, row, first + static_cast<std::uint32_t>(i), count - i, out + i);
+    }
+
+    __attribute__((target("avx2,fma"))) void absMinMaxAvx2(const float *values, std::size_t count, float &min, float &max)
+    {
+        const __m256 signMask = _mm256_set1_ps(-0.0f);
+        __m256 vmin = _mm256_set1_ps(min);
+        __m256 vmax = _mm256_set1_ps(max);
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256 v = _mm256_andnot_ps(signMask, _mm256_loadu_ps(values + i));
+            vmin = _mm256_min_ps(vmin, v);
+            vmax = _mm256_max_ps(vmax, v);
+        }
+        float lanes[8];
+        _mm256_storeu_ps(lanes, vmin);
+        for (float lane : lanes)
+            min = lane < min ? lane : min;
+        _mm256_storeu_ps(lanes, vmax);
+        for (float lane : lanes)
+            max = lane > max ? lane : max;
+        absMinMaxScalar(values + i, count - i, min, max);
+    }
+
+    __attribute__((target("avx2,fma"))) void scaleAbsAvx2(float *values, std::size_t count, float scale, float offset)
+    {
+        const __m256 signMask = _mm256_set1_ps(-0.0f);
+        const __m256 vscale = _mm256_set1_ps(scale);
+        const __m256 voffset = _mm256_set1_ps(offset);
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256 v = _mm256_andnot_ps(signMask, _mm256_loadu_ps(values + i));
+            _mm256_storeu_ps(values + i, _mm256_fmadd_ps(v, vscale, voffset));
+        }
+        scaleAbsScalar(values + i, count - i, scale, offset);
+    }
+
+    // ---- Échantillonnage de la surface : 8 points par registre, lectures par gather ----
+
+    __attribute__((target("avx2,fma"))) inline void catmullRom256(__m256 t, __m256 w[4])
+    {
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256 t2 = _mm256_mul_ps(t, t);
+        const __m256 t3 = _mm256_mul_ps(t2, t);
+        w[0] = _mm256_mul_ps(half, _mm256_sub_ps(_mm256_fmadd_ps(_mm256_set1_ps(2.0f), t2, _mm256_sub_ps(_mm256_setzero_ps(), t3)), t));
+        w[1] = _mm256_mul_ps(half, _mm256_fmadd_ps(_mm256_set1_ps(3.0f), t3, _mm256_fnmadd_ps(_mm256_set1_ps(5.0f), t2, _mm256_set1_ps(2.0f))));
+        w[2] = _mm256_mul_ps(half, _mm256_add_ps(_mm256_fmadd_ps(_mm256_set1_ps(4.0f), t2, _mm256_mul_ps(_mm256_set1_ps(-3.0f), t3)), t));
+        w[3] = _mm256_mul_ps(half, _mm256_sub_ps(t3, t2));
+    }
+
+    // (index + offset) mod size, décalé de shift bits (ligne) ou non (colonne)
+    __attribute__((target("avx2,fma"))) inline __m256i wrapIndex256(__m256i index, int offset, __m256i mask, __m128i shift)
+    {
+        return _mm256_sll_epi32(_mm256_and_si256(_mm256_add_epi32(index, _mm256_set1_epi32(offset)), mask), shift);
+    }
+
+    __attribute__((target("avx2,fma"))) inline __m256 gatherCell256(const float *field, __m256i row, __m256i column, __m128i channels)
+    {
+        return _mm256_i32gather_ps(field, _mm256_sll_epi32(_mm256_or_si256(row, column), channels), 4);
+    }
+
+    // Voir filterFieldKernel ; rowShift = log2(size), channelShift = log2(channels)
+    __attribute__((target("avx2,fma"))) inline __m256 filterField256(const float *field, int rowShift, int channelShift, __m256i mask,
+                                                                      SampleFilter filter, __m256 u, __m256 v)
+    {
+        const __m256 fu = _mm256_floor_ps(u);
+        const __m256 fv = _mm256_floor_ps(v);
+        const __m256 tu = _mm256_sub_ps(u, fu);
+        const __m256 tv = _mm256_sub_ps(v, fv);
+        const __m256i iu = _mm256_cvtps_epi32(fu);
+        const __m256i iv = _mm256_cvtps_epi32(fv);
+        const __m128i rows = _mm_cvtsi32_si128(rowShift);
+        const __m128i channels = _mm_cvtsi32_si128(channelShift);
+
+        if (filter == SAMPLE_BILINEAR)
+        {
+            const __m256i r0 = wrapIndex256(iu, 0, mask, rows), r1 = wrapIndex256(iu, 1, mask, rows);
+            const __m256i c0 = wrapIndex256(iv, 0, mask, _mm_setzero_si128()), c1 = wrapIndex256(iv, 1, mask, _mm_setzero_si128());
+            const __m256 g00 = gatherCell256(field, r0, c0, channels);
+            const __m256 g10 = gatherCell256(field, r1, c0, channels);
+            const __m256 a0 = _mm256_fmadd_ps(tv, _mm256_sub_ps(gatherCell256(field, r0, c1, channels), g00), g00);
+            const __m256 a1 = _mm256_fmadd_ps(tv, _mm256_sub_ps(gatherCell256(field, r1, c1, channels), g10), g10);
+            return _mm256_fmadd_ps(tu, _mm256_sub_ps(a1, a0), a0);
+        }
+
+        __m256 wu[4], wv[4];
+        catmullRom256(tu, wu);
+        catmullRom256(tv, wv);
+        __m256i c[4];
+        for (int b = 0; b < 4; ++b)
+            c[b] = wrapIndex256(iv, b - 1, mask, _mm_setzero_si128());
+        __m256 value = _mm256_setzero_ps();
+        for (int a = 0; a < 4; ++a)
+        {
+            const __m256i r = wrapIndex256(iu, a - 1, mask, rows);
+            __m256 sum = _mm256_mul_ps(wv[0], gatherCell256(field, r, c[0], channels));
+            for (int b = 1; b < 4; ++b)
+                sum = _mm256_fmadd_ps(wv[b], gatherCell256(field, r, c[b], channels), sum);
+            value = _mm256_fmadd_ps(wu[a], sum, value);
+        }
+        return value;
+    }
+
+    __attribute__((target("avx2,fma"))) void sampleSurfaceAvx2(const SurfaceFieldsF &surface, SampleFilter filter, int iterations, std::size_t count,
+                                                               const float *x, const float *z, float *heights, float *displacementX, float *displacementZ)
+    {
+        const int rowShift = __builtin_ctz(static_cast<unsigned>(surface.size));
+        const __m256i mask = _mm256_set1_epi32(surface.size - 1);
+        const __m256 scale = _mm256_set1_ps(surface.cellsPerMeter);
+        const __m256 chop = _mm256_set1_ps(surface.choppiness * surface.cellsPerMeter);
+        const __m256 choppiness = _mm256_set1_ps(surface.choppiness);
+        const float *dx = reinterpret_cast<const float *>(surface.displacements);
+        const float *dz = dx ? dx + 1 : nullptr;
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256 u = _mm256_mul_ps(_mm256_loadu_ps(x + i), scale);
+            const __m256 v = _mm256_mul_ps(_mm256_loadu_ps(z + i), scale);
+            __m256 pu = u;
+            __m256 pv = v;
+            for (int k = 0; k < iterations; ++k)
+            {
+                const __m256 du = filterField256(dx, rowShift, 1, mask, filter, pu, pv);
+                const __m256 dv = filterField256(dz, rowShift, 1, mask, filter, pu, pv);
+                pu = _mm256_fnmadd_ps(chop, du, u);
+                pv = _mm256_fnmadd_ps(chop, dv, v);
+            }
+            _mm256_storeu_ps(heights + i, filterField256(surface.heights, rowShift, 0, mask, filter, pu, pv));
+            if (displacementX)
+            {
+                _mm256_storeu_ps(displacementX + i, _mm256_mul_ps(choppiness, filterField256(dx, rowShift, 1, mask, filter, pu, pv)));
+                _mm256_storeu_ps(displacementZ + i, _mm256_mul_ps(choppiness, filterField256(dz, rowShift, 1, mask, filter, pu, pv)));
+            }
+        }
+        sampleSurfaceScalar(surface, filter, iterations, count - i, x + i, z + i, heights + i,
+                            displacementX ? displacementX + i : nullptr, displacementZ ? displacementZ + i : nullptr);
+    }
+
+    __attribute__((target("avx2,fma"))) inline float horizontalSum256(__m256 v)
+    {
+        const __m128 quad = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        const __m128 pair = _mm_add_ps(quad, _mm_movehl_ps(quad, quad));
+        return _mm_cvtss_f32(_mm_add_ss(pair, _mm_movehdup_ps(pair)));
+    }
+
+    // 8 modes par registre pour un point ; ModalEvaluator complète les modes
+    // par des modes nuls jusqu'à un multiple de 8, sinon la fin est scalaire
+    __attribute__((target("avx2,fma"))) void evaluateModesAvx2(const ModeSetF &modes, std::size_t count, const float *x, const float *z,
+                                                               float *heights, float *displacementX, float *displacementZ)
+    {
+        const std::size_t vectorModes = modes.count & ~static_cast<std::size_t>(7);
+        ModeSetF tail = modes;
+        tail.waveX += vectorModes;
+        tail.waveZ += vectorModes;
+        tail.phases += vectorModes;
+        tail.amplitudeRe += vectorModes;
+        tail.amplitudeIm += vectorModes;
+        tail.directionX += vectorModes;
+        tail.directionZ += vectorModes;
+        tail.count -= vectorModes;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            float u = x[i] * modes.inversePatchSize;
+            float v = z[i] * modes.inversePatchSize;
+            u -= std::floor(u);
+            v -= std::floor(v);
+            const __m256 vu = _mm256_set1_ps(u);
+            const __m256 vv = _mm256_set1_ps(v);
+            __m256 h = _mm256_setzero_ps();
+            __m256 dx = _mm256_setzero_ps();
+            __m256 dz = _mm256_setzero_ps();
+            for (std::size_t m = 0; m < vectorModes; m += 8)
+            {
+                const __m256 theta = _mm256_fmadd_ps(_mm256_loadu_ps(modes.waveX + m), vu,
+                                                     _mm256_fmadd_ps(_mm256_loadu_ps(modes.waveZ + m), vv, _mm256_loadu_ps(modes.phases + m)));
+                __m256 s, c;
+                sinCos256(theta, s, c);
+                const __m256 ar = _mm256_loadu_ps(modes.amplitudeRe + m);
+                const __m256 ai = _mm256_loadu_ps(modes.amplitudeIm + m);
+                h = _mm256_add_ps(h, _mm256_fmsub_ps(ar, c, _mm256_mul_ps(ai, s)));
+                if (displacementX)
+                {
+                    const __m256 im = _mm256_fmadd_ps(ar, s, _mm256_mul_ps(ai, c));
+                    dx = _mm256_fmadd_ps(_mm256_loadu_ps(modes.directionX + m), im, dx);
+                    dz = _mm256_fmadd_ps(_mm256_loadu_ps(modes.directionZ + m), im, dz);
+                }
+            }
+
+            float tailHeight = 0, tailX = 0, tailZ = 0;
+            if (tail.count)
+                evaluateModesScalar(tail, 1, x + i, z + i, &tailHeight, &tailX, &tailZ);
+            heights[i] = horizontalSum256(h) + tailHeight;
+            if (displacementX)
+            {
+                displacementX[i] = horizontalSum256(dx) + tailX;
+                displacementZ[i] = horizontalSum256(dz) + tailZ;
+            }
+        }
+    }
+
+    // 8 pixels d'une ligne par itération, à partir d'un multiple de 8 : les
+    // lignes des tampons sont des multiples de 8, les voies hors de [x0, x1) sont
+    // masquées. Fonctions d'arête et profondeur évaluées en chaque pixel, sans
+    // cumul d'un pas, dans l'ordre des opérations de rasterTriangleKernel ; cible
+    // avx2 sans fma pour que le compilateur ne fusionne pas les produits et les
+    // sommes : mêmes pixels couverts et mêmes profondeurs que le scalaire, au bit près
+    __attribute__((target("avx2"))) void rasterTriangleAvx2(const RasterTriangleF &triangle, std::uint32_t id, const RasterTargetF &target,
+                                                            int x0, int y0, int x1, int y1)
+    {
+        const int start = x0 & ~7;
+        const __m256i laneIndex = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i low = _mm256_set1_epi32(x0 - 1);
+        const __m256i high = _mm256_set1_epi32(x1);
+        const __m256i ids = _mm256_set1_epi32(static_cast<int>(id));
+        const __m256 half = _mm256_set1_ps(0.5f);
+        __m256 a[3], c[3], bias[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            a[k] = _mm256_set1_ps(triangle.edgeA[k]);
+            c[k] = _mm256_set1_ps(triangle.edgeC[k]);
+            bias[k] = _mm256_set1_ps(triangle.bias[k]);
+        }
+        const __m256 depthA = _mm256_set1_ps(triangle.depthA);
+        const __m256 depthC = _mm256_set1_ps(triangle.depthC);
+
+        for (int y = y0; y < y1; ++y)
+        {
+            const float v = y - triangle.minY + 0.5f;
+            float *depthRow = target.depth + static_cast<std::size_t>(y) * target.stride;
+            std::uint32_t *idRow = target.ids + static_cast<std::size_t>(y) * target.stride;
+            __m256 bv[3];
+            for (int k = 0; k < 3; ++k)
+                bv[k] = _mm256_set1_ps(triangle.edgeB[k] * v);
+            const __m256 depthBV = _mm256_set1_ps(triangle.depthB * v);
+            for (int x = start; x < x1; x += 8)
+            {
+                const __m256i column = _mm256_add_epi32(_mm256_set1_epi32(x), laneIndex);
+                const __m256 u = _mm256_add_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(column, _mm256_set1_epi32(triangle.minX))), half);
+                __m256 mask = _mm256_castsi256_ps(_mm256_and_si256(_mm256_cmpgt_epi32(column, low), _mm256_cmpgt_epi32(high, column)));
+                for (int k = 0; k < 3; ++k)
+                {
+                    const __m256 e = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a[k], u), bv[k]), c[k]);
+                    mask = _mm256_and_ps(mask, _mm256_cmp_ps(e, bias[k], _CMP_GT_OQ));
+                }
+                if (_mm256_movemask_ps(mask))
+                {
+                    const __m256 z = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(depthA, u), depthBV), depthC);
+                    const __m256 depth = _mm256_loadu_ps(depthRow + x);
+                    mask = _mm256_and_ps(mask, _mm256_cmp_ps(z, depth, _CMP_LT_OQ));
+                    _mm256_storeu_ps(depthRow + x, _mm256_blendv_ps(depth, z, mask));
+                    __m256i *idPointer = reinterpret_cast<__m256i *>(idRow + x);
+                    const __m256i previous = _mm256_loadu_si256(idPointer);
+                    _mm256_storeu_si256(idPointer, _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(previous), _mm256_castsi256_ps(ids), mask)));
+                }
+            }
+        }
+    }
+
+#endif // OCEAN_X86_DISPATCH
+
+    KernelTable selectKernels()
+    {
+#ifdef OCEAN_X86_DISPATCH
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            return KernelTable{"avx2", radix4PassAvx2, evolveSpectrumAvx2, evolveRotorAvx2, gaussianRowAvx2, absMinMaxAvx2, scaleAbsAvx2, sampleSurfaceAvx2, evaluateModesAvx2, rasterTriangleAvx2};
+        if (__builtin_cpu_supports("sse3"))
+            return KernelTable{"sse3", radix4PassSse, evolveSpectrumScalar, evolveRotorScalar, gaussianRowScalar, absMinMaxSse, scaleAbsSse, sampleSurfaceScalar, evaluateModesScalar, rasterTriangleScalar};
+#endif
+        return KernelTable{"scalar", radix4PassScalar, evolveSpectrumScalar, evolveRotorScalar, gaussianRowScalar, absMinMaxScalar, scaleAbsScalar, sampleSurfaceScalar, evaluateModesScalar, rasterTriangleScalar};
+    }
+
+    const KernelTable &kernels()
+    {
+        static const KernelTable table = selectKernels();
+        return table;
+    }
+}
+
+void radix4PassKernel(ComplexF *data, int n, int half, const ComplexF *w1, const ComplexF *w2)
+{
+    kernels().radix4Pass(data, n, half, w1, w2);
+}
+
+void evolveSpectrumKernel(float t, std::size_t count, const ComplexF *h0, const ComplexF *h0Mirror, const float *omega,
+                          const ComplexF *directions, const ComplexF *waveVectors, const SpectralFieldsF &out)
+{
+    kernels().evolveSpectrum(t, count, h0, h0Mirror, omega, directions, waveVectors, out);
+}
+
+void evolveRotorKernel(std::size_t count, const ComplexF *h0, const ComplexF *h0Mirror, ComplexF *phases, const ComplexF *rotors,
+                       const ComplexF *directions, const ComplexF *waveVectors, const SpectralFieldsF &out)
+{
+    kernels().evolveRotor(count, h0, h0Mirror, phases, rotors, directions, waveVectors, out);
+}
+
+void gaussianRowKernel(std::uint32_t seed, std::uint32_t row, std::uint32_t first, std::size_t count, ComplexF *out)
+{
+    kernels().gaussianRow(seed, row, first, count, out);
+}
+
+void absMinMaxKernel(const float *values, std::size_t count, float &min, float &max)
+{
+    kernels().absMinMax(values, count, min, max);
+}
+
+void scaleAbsKernel(float *values, std::size_t count, float scale, float offset)
+{
+    kernels().scaleAbs(values, count, scale, offset);
+}
+
+void sampleSurfaceKernel(const SurfaceFieldsF &surface, SampleFilter filter, int iterations, std::size_t count,
+                         const float *x, const float *z, float *heights, float *displacementX, float *displacementZ)
+{
+    kernels().sampleSurface(surface, filter, iterations, count, x, z, heights, displacementX, displacementZ);
+}
+
+void evaluateModesKernel(const ModeSetF &modes, std::size_t count, const float *x, const float *z, float *heights,
+                         float *displacementX, float *displacementZ)
+{
+    kernels().evaluateModes(modes, count, x, z, heights, displacementX, displacementZ);
+}
+
+void rasterTriangleKernel(const RasterTriangleF &triangle, std::uint32_t id, const RasterTargetF &target, int x0, int y0, int x1, int y1)
+{
+    kernels().rasterTriangle(triangle, id, target, x0, y0, x1, y1);
+}
+
+const char *simdKernelName()
+{
+    return kernels().name;
+}
@@ -0,0 +1,376 @@
+#ifndef SIMDKERNELS_H
+#define SIMDKERNELS_H
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include "Philox.hh"
+
+// Noyaux de calcul du chemin par frame.
+// Les versions génériques (templates) servent de référence portable et sont
+// utilisées pour le double. Les surcharges float choisissent à l'exécution
+// une implémentation AVX2/FMA, SSE3 ou scalaire selon le CPU.
+
+// Une passe radix-4 de la FFT inverse : blocs de taille half -> 4 * half.
+// w1[k] et w2[k] (k < half) sont les twiddles des deux étages radix-2 fusionnés.
+template <typename Real>
+inline void radix4PassKernel(std::complex<Real> *data, int n, int half, const std::complex<Real> *w1, const std::complex<Real> *w2)
+{
+    typedef std::complex<Real> ComplexT;
+    for (int b = 0; b < n; b += 4 * half)
+    {
+        for (int k = 0; k < half; ++k)
+        {
+            const ComplexT a0 = data[b + k];
+            const ComplexT a1 = w1[k] * data[b + k + half];
+            const ComplexT a2 = data[b + k + 2 * half];
+            const ComplexT a3 = w1[k] * data[b + k + 3 * half];
+
+            const ComplexT t0 = a0 + a1;
+            const ComplexT t1 = a0 - a1;
+            const ComplexT t2 = w2[k] * (a2 + a3);
+            const ComplexT t3 = w2[k] * (a2 - a3);
+            // Multiplication par i : exp(+iπ/2) pour la transformée inverse
+            const ComplexT t3i = ComplexT(-t3.imag(), t3.real());
+
+            data[b + k] = t0 + t2;
+            data[b + k + 2 * half] = t0 - t2;
+            data[b + k + half] = t1 + t3i;
+            data[b + k + 3 * half] = t1 - t3i;
+        }
+    }
+}
+
+// Spectres de travail d'une frame, empaquetés par paires de champs réels a + i b :
+// les deux champs sont hermitiens, une seule IFFT complexe donne a et b.
+// Convention de la grille : la synthèse se fait en exp(-ik.x), d/dx <-> -i kx.
+template <typename Real>
+struct SpectralFields
+{
+    std::complex<Real> *heights;       // h + i dDx/dz
+    std::complex<Real> *displacements; // Dx + i Dz, avec D = -i k/|k| h
+    std::complex<Real> *slopes;        // dh/dx + i dh/dz
+    std::complex<Real> *jacobian;      // dDx/dx + i dDz/dz
+};
+
+// Les quatre spectres de la cellule i à partir de h(k, t), de la direction k / |k|
+// et du vecteur d'onde k (kx + i kz)
+template <typename Real>
+inline void storeSpectralFields(const std::complex<Real> &spec, const std::complex<Real> &dir, const std::complex<Real> &k,
+                                const SpectralFields<Real> &out, std::size_t i)
+{
+    typedef std::complex<Real> ComplexT;
+    const ComplexT d = dir * spec;
+    const ComplexT s = k * spec;
+    out.heights[i] = spec * ComplexT(1, -k.real() * dir.imag());
+    out.displacements[i] = ComplexT(d.imag(), -d.real());
+    out.slopes[i] = ComplexT(s.imag(), -s.real());
+    out.jacobian[i] = -(spec * ComplexT(k.real() * dir.real(), k.imag() * dir.imag()));
+}
+
+// h(k, t) = h0(k) exp(iwt) + conj(h0(-k)) exp(-iwt), puis les spectres dérivés.
+// h0Mirror contient conj(h0(-k)). Les entrées sont lues en [0, count), les
+// sorties écrites en out.xxx[0, count).
+template <typename Real>
+inline void evolveSpectrumKernel(float t, std::size_t count, const std::complex<Real> *h0, const std::complex<Real> *h0Mirror,
+                                 const Real *omega, const std::complex<Real> *directions, const std::complex<Real> *waveVectors,
+                                 const SpectralFields<Real> &out)
+{
+    typedef std::complex<Real> ComplexT;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const Real wt = omega[i] * t;
+        const ComplexT e(std::cos(wt), std::sin(wt));
+        const ComplexT spec = h0[i] * e + h0Mirror[i] * std::conj(e);
+        storeSpectralFields(spec, directions[i], waveVectors[i], out, i);
+    }
+}
+
+// Même évolution à partir des phases exp(iwt) déjà connues, sans sin/cos :
+// les phases sont ensuite avancées d'un pas, phases[i] *= rotors[i].
+template <typename Real>
+inline void evolveRotorKernel(std::size_t count, const std::complex<Real> *h0, const std::complex<Real> *h0Mirror,
+                              std::complex<Real> *phases, const std::complex<Real> *rotors, const std::complex<Real> *directions,
+                              const std::complex<Real> *waveVectors, const SpectralFields<Real> &out)
+{
+    typedef std::complex<Real> ComplexT;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const ComplexT e = phases[i];
+        const ComplexT spec = h0[i] * e + h0Mirror[i] * std::conj(e);
+        storeSpectralFields(spec, directions[i], waveVectors[i], out, i);
+        phases[i] = e * rotors[i];
+    }
+}
+
+// Gaussiennes des colonnes [first, first + count) de la ligne row du spectre :
+// out[j] = g0 + i g1, avec g0 et g1 indépendantes de loi N(0, 1), obtenues par
+// Box-Muller à partir du bloc Philox4x32-10 de compteur (colonne, row, 0, 0)
+// et de clé (seed, 0).
+template <typename Real>
+inline void gaussianRowKernel(std::uint32_t seed, std::uint32_t row, std::uint32_t first, std::size_t count, std::complex<Real> *out)
+{
+    const Real twoPi = static_cast<Real>(6.283185307179586);
+    for (std::size_t j = 0; j < count; ++j)
+    {
+        const PhiloxBlock block = philox4x32(first + static_cast<std::uint32_t>(j), row, 0, 0, seed, 0);
+        // u1 dans (0, 1] pour le logarithme, u2 dans [0, 1)
+        const Real u1 = static_cast<Real>((block.v[0] >> 8) + 1) * static_cast<Real>(1.0 / 16777216.0);
+        const Real u2 = static_cast<Real>(block.v[1] >> 8) * static_cast<Real>(1.0 / 16777216.0);
+        const Real radius = std::sqrt(-2 * std::log(u1));
+        out[j] = std::polar(radius, twoPi * u2);
+    }
+}
+
+// min et max de |values[i]|
+template <typename Real>
+inline void absMinMaxKernel(const Real *values, std::size_t count, Real &min, Real &max)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const Real value = std::abs(values[i]);
+        if (value < min)
+            min = value;
+        if (value > max)
+            max = value;
+    }
+}
+
+// values[i] = |values[i]| * scale + offset
+template <typename Real>
+inline void scaleAbsKernel(Real *values, std::size_t count, Real scale, Real offset)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        values[i] = std::abs(values[i]) * scale + offset;
+    }
+}
+
+enum SampleFilter
+{
+    SAMPLE_BILINEAR,
+    SAMPLE_BICUBIC // Catmull-Rom, 4 x 4 cellules
+};
+
+// Champs d'une frame lus par l'échantillonnage : grille size x size périodique
+// (size puissance de deux), i selon x et j selon z, valeurs en mètres
+template <typename Real>
+struct SurfaceFields
+{
+    const Real *heights;
+    const std::complex<Real> *displacements; // Dx + i Dz, nul sans déplacements
+    int size;
+    Real cellsPerMeter;
+    Real choppiness;
+};
+
+// Poids de Catmull-Rom des cellules -1, 0, 1 et 2 pour la fraction t
+template <typename Real>
+inline void catmullRomWeights(Real t, Real w[4])
+{
+    w[0] = ((-t + 2) * t - 1) * t / 2;
+    w[1] = ((3 * t - 5) * t * t + 2) / 2;
+    w[2] = ((-3 * t + 4) * t + 1) * t / 2;
+    w[3] = (t - 1) * t * t / 2;
+}
+
+// Valeur filtrée au point (u, v), en cellules, d'un champ de channels valeurs
+// par cellule (field pointe sur le canal lu), avec repliement périodique
+template <typename Real>
+inline Real filterFieldKernel(const Real *field, int channels, int size, SampleFilter filter, Real u, Real v)
+{
+    const int mask = size - 1;
+    const Real fu = std::floor(u);
+    const Real fv = std::floor(v);
+    const Real tu = u - fu;
+    const Real tv = v - fv;
+    const int iu = static_cast<int>(fu) & mask;
+    const int iv = static_cast<int>(fv) & mask;
+    auto at = [&](int i, int j) { return field[static_cast<std::size_t>(((i & mask) * size + (j & mask)) * channels)]; };
+
+    if (filter == SAMPLE_BILINEAR)
+    {
+        const Real r0 = at(iu, iv) + tv * (at(iu, iv + 1) - at(iu, iv));
+        const Real r1 = at(iu + 1, iv) + tv * (at(iu + 1, iv + 1) - at(iu + 1, iv));
+        return r0 + tu * (r1 - r0);
+    }
+
+    Real wu[4], wv[4];
+    catmullRomWeights(tu, wu);
+    catmullRomWeights(tv, wv);
+    Real value = 0;
+    for (int a = 0; a < 4; ++a)
+    {
+        Real row = 0;
+        for (int b = 0; b < 4; ++b)
+            row += wv[b] * at(iu + a - 1, iv + b - 1);
+        value += wu[a] * row;
+    }
+    return value;
+}
+
+// Hauteur de la surface aux points (x[i], z[i]) en mètres. Avec iterations > 0,
+// le point de la grille p tel que p + choppiness D(p) = (x, z) est d'abord
+// cherché par itération de point fixe : la hauteur est alors celle de la
+// surface déplacée, celle qu'on voit au-dessus de (x, z). displacementX et
+// displacementZ (choppiness D au point trouvé) peuvent être nuls.
+template <typename Real>
+inline void sampleSurfaceKernel(const SurfaceFields<Real> &surface, SampleFilter filter, int iterations, std::size_t count,
+                                const Real *x, const Real *z, Real *heights, Real *displacementX, Real *displacementZ)
+{
+    const Real *dx = reinterpret_cast<const Real *>(surface.displacements);
+    const Real chop = surface.choppiness * surface.cellsPerMeter;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const Real u = x[i] * surface.cellsPerMeter;
+        const Real v = z[i] * surface.cellsPerMeter;
+        Real pu = u;
+        Real pv = v;
+        for (int k = 0; k < iterations; ++k)
+        {
+            const Real du = filterFieldKernel(dx, 2, surface.size, filter, pu, pv);
+            const Real dv = filterFieldKernel(dx + 1, 2, surface.size, filter, pu, pv);
+            pu = u - chop * du;
+            pv = v - chop * dv;
+        }
+        heights[i] = filterFieldKernel(surface.heights, 1, surface.size, filter, pu, pv);
+        if (displacementX)
+        {
+            displacementX[i] = surface.choppiness * filterFieldKernel(dx, 2, surface.size, filter, pu, pv);
+            displacementZ[i] = surface.choppiness * filterFieldKernel(dx + 1, 2, surface.size, filter, pu, pv);
+        }
+    }
+}
+
+// Modes du spectre sommés directement (voir ModalEvaluator). Chaque mode est
+// une onde Re[a exp(i (kx u + kz v + phase))], (u, v) étant la position en
+// fraction du domaine et (kx, kz) en radians par domaine. Les déplacements
+// sont Σ direction Im[...], choppiness comprise dans direction.
+template <typename Real>
+struct ModeSet
+{
+    const Real *waveX;
+    const Real *waveZ;
+    const Real *phases; // w t, ramené dans [0, 2π)
+    const Real *amplitudeRe;
+    const Real *amplitudeIm;
+    const Real *directionX;
+    const Real *directionZ;
+    std::size_t count;
+    Real inversePatchSize;
+};
+
+// Somme des modes aux points (x[i], z[i]) en mètres ; displacementX et
+// displacementZ peuvent être nuls
+template <typename Real>
+inline void evaluateModesKernel(const ModeSet<Real> &modes, std::size_t count, const Real *x, const Real *z, Real *heights,
+                                Real *displacementX, Real *displacementZ)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        // Position ramenée dans le domaine : les phases restent petites en float
+        Real u = x[i] * modes.inversePatchSize;
+        Real v = z[i] * modes.inversePatchSize;
+        u -= std::floor(u);
+        v -= std::floor(v);
+        Real h = 0, dx = 0, dz = 0;
+        for (std::size_t m = 0; m < modes.count; ++m)
+        {
+            const Real theta = modes.waveX[m] * u + modes.waveZ[m] * v + modes.phases[m];
+            const Real c = std::cos(theta);
+            const Real s = std::sin(theta);
+            const Real re = modes.amplitudeRe[m] * c - modes.amplitudeIm[m] * s;
+            const Real im = modes.amplitudeRe[m] * s + modes.amplitudeIm[m] * c;
+            h += re;
+            dx += modes.directionX[m] * im;
+            dz += modes.directionZ[m] * im;
+        }
+        heights[i] = h;
+        if (displacementX)
+        {
+            displacementX[i] = dx;
+            displacementZ[i] = dz;
+        }
+    }
+}
+
+// Triangle projeté, prêt pour la rastérisation par tuiles (voir SoftwareRenderer).
+// Les coordonnées sont en pixels, relatives au coin (minX, minY) de la boîte
+// englobante pour garder la précision des grands triangles. Le pixel (x, y)
+// est couvert si ses trois fonctions d'arête, prises en son centre, dépassent
+// bias[k] : 0, ou -denorm_min sur les arêtes haut-gauche, de sorte qu'un pixel
+// posé sur une arête commune n'appartienne qu'à un seul des deux triangles.
+template <typename Real>
+struct RasterTriangle
+{
+    Real edgeA[3]; // e_k(u, v) = edgeA[k] u + edgeB[k] v + edgeC[k], u = x - minX + 0.5
+    Real edgeB[3];
+    Real edgeC[3];
+    Real bias[3];
+    Real depthA, depthB, depthC; // Profondeur dans [0, 1], affine en espace écran
+    int minX, minY, maxX, maxY;  // Pixels candidats [minX, maxX) x [minY, maxY)
+};
+
+// Tampons de profondeur et d'identifiants de triangle, stride pixels par ligne
+// (multiple de 8)
+template <typename Real>
+struct RasterTarget
+{
+    Real *depth;
+    std::uint32_t *ids;
+    std::size_t stride;
+};
+
+// Pixels couverts de [x0, x1) x [y0, y1) (inclus dans la boîte du triangle) :
+// là où le triangle est strictement plus proche, sa profondeur et id sont écrits
+template <typename Real>
+inline void rasterTriangleKernel(const RasterTriangle<Real> &triangle, std::uint32_t id, const RasterTarget<Real> &target,
+                                 int x0, int y0, int x1, int y1)
+{
+    for (int y = y0; y < y1; ++y)
+    {
+        const Real v = y - triangle.minY + Real(0.5);
+        Real *depth = target.depth + static_cast<std::size_t>(y) * target.stride;
+        std::uint32_t *ids = target.ids + static_cast<std::size_t>(y) * target.stride;
+        for (int x = x0; x < x1; ++x)
+        {
+            const Real u = x - triangle.minX + Real(0.5);
+            bool inside = true;
+            for (int k = 0; k < 3; ++k)
+                inside = inside && triangle.edgeA[k] * u + triangle.edgeB[k] * v + triangle.edgeC[k] > triangle.bias[k];
+            const Real z = triangle.depthA * u + triangle.depthB * v + triangle.depthC;
+            if (inside && z < depth[x])
+            {
+                depth[x] = z;
+                ids[x] = id;
+            }
+        }
+    }
+}
+
+typedef std::complex<float> ComplexF;
+typedef SpectralFields<float> SpectralFieldsF;
+typedef SurfaceFields<float> SurfaceFieldsF;
+typedef ModeSet<float> ModeSetF;
+typedef RasterTriangle<float> RasterTriangleF;
+typedef RasterTarget<float> RasterTargetF;
+
+void radix4PassKernel(ComplexF *data, int n, int half, const ComplexF *w1, const ComplexF *w2);
+void evolveSpectrumKernel(float t, std::size_t count, const ComplexF *h0, const ComplexF *h0Mirror, const float *omega,
+                          const ComplexF *directions, const ComplexF *waveVectors, const SpectralFieldsF &out);
+void evolveRotorKernel(std::size_t count, const ComplexF *h0, const ComplexF *h0Mirror, ComplexF *phases, const ComplexF *rotors,
+                       const ComplexF *directions, const ComplexF *waveVectors, const SpectralFieldsF &out);
+void gaussianRowKernel(std::uint32_t seed, std::uint32_t row, std::uint32_t first, std::size_t count, ComplexF *out);
+void absMinMaxKernel(const float *values, std::size_t count, float &min, float &max);
+void scaleAbsKernel(float *values, std::size_t count, float scale, float offset);
+void sampleSurfaceKernel(const SurfaceFieldsF &surface, SampleFilter filter, int iterations, std::size_t count,
+                         const float *x, const float *z, float *heights, float *displacementX, float *displacementZ);
+void evaluateModesKernel(const ModeSetF &modes, std::size_t count, const float *x, const float *z, float *heights,
+                         float *displacementX, float *displacementZ);
+void rasterTriangleKernel(const RasterTriangleF &triangle, std::uint32_t id, const RasterTargetF &target, int x0, int y0, int x1, int y1);
+
+// Nom du jeu d'instructions retenu pour les noyaux float ("avx2", "sse3" ou "scalar")
+const char *simdKernelName();
+
+#endif // SIMDKERNELS_H
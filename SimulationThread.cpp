@@ -0,0 +1,130 @@
+#include "SimulationThread.hh"
+#include "heightmap.hh"
+#include "Profiler.hh"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    // Même horloge que Profiler::nowNs
+    std::uint64_t steadyNowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    SimulatedFrame emptyFrame(const OceanCascades &ocean, const VertexBuilder &builder)
+    {
+        SimulatedFrame frame;
+        frame.vertices.resize(static_cast<std::size_t>(ocean.getResolution()) * ocean.getResolution() * builder.stride());
+        return frame;
+    }
+}
+
+SimulationThread::SimulationThread(OceanCascades &ocean, const FrameCache &cache, VertexBuilder &builder, double rate)
+    : ocean(ocean), cache(cache), builder(builder), rate(rate), frames(emptyFrame(ocean, builder)), produced(0), dropped(0),
+      stopping(false), failed(false), displayed(0), latencyTotalNs(0), latencyMaxNs(0)
+{
+    if (!(rate > 0))
+        throw std::invalid_argument("SimulationThread: fréquence de simulation invalide");
+    if (!cache.empty() && ocean.getCascadeCount() > 1)
+        throw std::invalid_argument("SimulationThread: le mode boucle ne rejoue qu'une cascade");
+
+    if (cache.empty())
+        ocean.setupPhaseRotors(0.0f, static_cast<float>(1.0 / rate));
+    worker = std::thread(&SimulationThread::simulationLoop, this);
+}
+
+SimulationThread::~SimulationThread()
+{
+    stopping.store(true, std::memory_order_relaxed);
+    if (worker.joinable())
+        worker.join();
+}
+
+void SimulationThread::simulate(SimulatedFrame &frame, std::uint64_t sequence)
+{
+    if (cache.empty())
+    {
+        frame.time = ocean.cascade(0).rotorClock().time;
+        ocean.step();
+        OCEAN_PROFILE_SCOPE(STAGE_VERTICES);
+        builder.build(ocean.heights(), ocean.displacements(), ocean.slopes(),
+                      Span<float>(frame.vertices.data(), frame.vertices.size()));
+    }
+    else
+    {
+        // Mode boucle : frame du cache la plus proche, seules les hauteurs sont rejouées
+        frame.time = (sequence - 1) / rate;
+        const double framesPerSecond = cache.getFrameCount() / cache.getPeriod();
+        OceanStateF &state = ocean.cascade(0);
+        cache.decode(static_cast<int>(std::llround(frame.time * framesPerSecond) % cache.getFrameCount()), state.heights());
+        OCEAN_PROFILE_SCOPE(STAGE_VERTICES);
+        builder.build(state.heights(), Span<const std::complex<float>>(), Span<const std::complex<float>>(),
+                      Span<float>(frame.vertices.data(), frame.vertices.size()));
+    }
+    frame.sequence = sequence;
+}
+
+void SimulationThread::simulationLoop()
+{
+    typedef std::chrono::steady_clock Clock;
+    const Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+    Clock::time_point next = Clock::now();
+    try
+    {
+        for (std::uint64_t sequence = 1; !stopping.load(std::memory_order_relaxed); ++sequence)
+        {
+            SimulatedFrame &frame = frames.writeBuffer();
+            simulate(frame, sequence);
+            frame.publishedNs = steadyNowNs();
+            if (frames.publish())
+                dropped.fetch_add(1, std::memory_order_relaxed);
+            produced.fetch_add(1, std::memory_order_relaxed);
+
+            // En retard : on repart de maintenant, sans pas de rattrapage
+            next += period;
+            const Clock::time_point now = Clock::now();
+            if (next < now)
+                next = now;
+            else
+                std::this_thread::sleep_until(next);
+        }
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+        failed.store(true, std::memory_order_release);
+    }
+}
+
+const SimulatedFrame *SimulationThread::acquire()
+{
+    if (failed.load(std::memory_order_acquire))
+        std::rethrow_exception(error);
+    if (!frames.update())
+        return nullptr;
+
+    const SimulatedFrame &frame = frames.readBuffer();
+    const std::uint64_t now = steadyNowNs();
+    const std::uint64_t latency = now > frame.publishedNs ? now - frame.publishedNs : 0;
+    ++displayed;
+    latencyTotalNs += latency;
+    latencyMaxNs = std::max(latencyMaxNs, latency);
+    OCEAN_PROFILE_RECORD(STAGE_HANDOFF, frame.publishedNs, latency);
+    return &frame;
+}
+
+double SimulationThread::getRate() const { return rate; }
+
+HandoffStats SimulationThread::stats() const
+{
+    HandoffStats result;
+    result.produced = produced.load(std::memory_order_relaxed);
+    result.dropped = dropped.load(std::memory_order_relaxed);
+    result.displayed = displayed;
+    result.meanLatencyMs = displayed ? latencyTotalNs / 1e6 / displayed : 0.0;
+    result.maxLatencyMs = latencyMaxNs / 1e6;
+    return result;
+}
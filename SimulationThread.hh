@@ -0,0 +1,83 @@
+#ifndef SIMULATIONTHREAD_H
+#define SIMULATIONTHREAD_H
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <thread>
+#include <vector>
+#include "FrameCache.hh"
+#include "Mesh.hh"
+#include "OceanCascades.hh"
+#include "TripleBuffer.hh"
+
+// Frame produite par le thread de simulation
+struct SimulatedFrame
+{
+    std::vector<float> vertices; // Sortie de VertexBuilder
+    double time = 0;             // Temps simulé (s)
+    std::uint64_t sequence = 0;  // Numéro de la frame, à partir de 1
+    std::uint64_t publishedNs = 0; // Instant de publication (horloge monotone)
+};
+
+struct HandoffStats
+{
+    std::uint64_t produced = 0;  // Frames publiées
+    std::uint64_t dropped = 0;   // Remplacées avant d'avoir été lues par le rendu
+    std::uint64_t displayed = 0; // Lues par le rendu
+    double meanLatencyMs = 0;    // Publication -> acquisition par le rendu
+    double maxLatencyMs = 0;
+};
+
+// Simulation sur un thread dédié, cadencée sur l'horloge murale : à rate Hz,
+// chaque pas avance le temps simulé de 1 / rate s (StepHeights, ou la frame
+// correspondante de cache en mode boucle) et construit les sommets de la surface
+// combinée des cascades, puis les
+// publie dans un TripleBuffer. Le rendu récupère la dernière frame complète
+// sans verrou ni attente. Si un pas dure plus que 1 / rate, la simulation
+// prend du retard sur l'horloge au lieu d'enchaîner des pas de rattrapage.
+// ocean, cache et builder appartiennent au thread de simulation jusqu'à la
+// destruction de l'objet.
+class SimulationThread
+{
+private:
+    OceanCascades &ocean;
+    const FrameCache &cache;
+    VertexBuilder &builder;
+    double rate;
+
+    TripleBuffer<SimulatedFrame> frames;
+    std::atomic<std::uint64_t> produced;
+    std::atomic<std::uint64_t> dropped;
+    std::atomic<bool> stopping;
+    std::atomic<bool> failed;
+    std::exception_ptr error; // Erreur du thread de simulation, relancée par acquire()
+
+    // Côté rendu
+    std::uint64_t displayed;
+    std::uint64_t latencyTotalNs;
+    std::uint64_t latencyMaxNs;
+
+    std::thread worker;
+
+    void simulationLoop();
+    void simulate(SimulatedFrame &frame, std::uint64_t sequence);
+
+public:
+    // ocean doit contenir un spectre (generate) ; les rotors de phase sont
+    // initialisés ici au pas 1 / rate quand cache est vide. Le mode boucle
+    // n'accepte qu'une cascade.
+    SimulationThread(OceanCascades &ocean, const FrameCache &cache, VertexBuilder &builder, double rate);
+    ~SimulationThread();
+    SimulationThread(const SimulationThread &) = delete;
+    SimulationThread &operator=(const SimulationThread &) = delete;
+
+    // Rendu : dernière frame publiée si elle est nouvelle, nullptr sinon.
+    // Le pointeur reste valide jusqu'à l'appel suivant.
+    const SimulatedFrame *acquire();
+
+    double getRate() const;
+    HandoffStats stats() const; // À appeler depuis le thread de rendu
+};
+
+#endif // SIMULATIONTHREAD_H
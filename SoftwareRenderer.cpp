@@ -0,0 +1,335 @@
+#include "SoftwareRenderer.hh"
+#include "Mesh.hh"
+#include "Profiler.hh"
+#include "ThreadPool.hh"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    const std::uint32_t EMPTY_PIXEL = 0xFFFFFFFFu;
+    // Identifiant d'un triangle : bloc dans les 8 bits de poids fort, rang dans le bloc ensuite
+    const int CHUNK_SHIFT = 24;
+    const int MAX_CHUNKS = 255;
+
+    struct ClipVertex
+    {
+        glm::vec4 clip;
+        glm::vec3 position;
+        glm::vec3 normal;
+    };
+
+    ClipVertex lerp(const ClipVertex &a, const ClipVertex &b, float t)
+    {
+        return ClipVertex{a.clip + (b.clip - a.clip) * t, a.position + (b.position - a.position) * t, a.normal + (b.normal - a.normal) * t};
+    }
+
+    // Polygone coupé par le plan proche z + w >= 0 de l'espace de découpage d'OpenGL (au plus 4 sommets)
+    int clipNear(const ClipVertex (&in)[3], ClipVertex (&out)[4])
+    {
+        int count = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            const ClipVertex &a = in[k];
+            const ClipVertex &b = in[(k + 1) % 3];
+            const float da = a.clip.z + a.clip.w;
+            const float db = b.clip.z + b.clip.w;
+            if (da >= 0)
+                out[count++] = a;
+            if ((da >= 0) != (db >= 0))
+                out[count++] = lerp(a, b, da / (da - db));
+        }
+        return count;
+    }
+
+    // Vrai si les trois sommets sont du même côté extérieur d'un plan du volume de vue
+    bool outsideFrustum(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c)
+    {
+        return (a.x > a.w && b.x > b.w && c.x > c.w) || (a.x < -a.w && b.x < -b.w && c.x < -c.w) ||
+               (a.y > a.w && b.y > b.w && c.y > c.w) || (a.y < -a.w && b.y < -b.w && c.y < -c.w) ||
+               (a.z > a.w && b.z > b.w && c.z > c.w) || (a.z < -a.w && b.z < -b.w && c.z < -c.w);
+    }
+
+    unsigned char toByte(float value)
+    {
+        return static_cast<unsigned char>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+SoftwareRenderer::SoftwareRenderer(int width, int height, int gridSize)
+    : width(width), height(height), gridSize(gridSize), stride((static_cast<std::size_t>(width) + 7) & ~static_cast<std::size_t>(7)),
+      tilesX((width + TILE_SIZE - 1) / TILE_SIZE), tilesY((height + TILE_SIZE - 1) / TILE_SIZE),
+      topology(MeshTopology::get(gridSize, TOPOLOGY_ROWS)), background(0.0f)
+{
+    if (width < 1 || height < 1)
+        throw std::invalid_argument("SoftwareRenderer: taille d'image invalide");
+
+    const std::size_t cells = static_cast<std::size_t>(gridSize) * gridSize;
+    clipPositions.resize(cells);
+    // Environ quatre blocs de triangles par thread pour équilibrer la préparation
+    chunks.resize(std::min(std::max(4 * ThreadPool::shared().getThreadCount(), 4), MAX_CHUNKS));
+    // Le découpage par le plan proche donne au plus deux triangles par triangle du bloc
+    const std::size_t perChunk = (topology.triangleCount() + chunks.size() - 1) / chunks.size();
+    if (2 * perChunk > (1u << CHUNK_SHIFT))
+        throw std::invalid_argument("SoftwareRenderer: trop de triangles par bloc pour les identifiants");
+    for (Chunk &chunk : chunks)
+        chunk.bins.resize(static_cast<std::size_t>(tilesX) * tilesY);
+    depth.resize(stride * height);
+    ids.resize(stride * height);
+    image.resize(static_cast<std::size_t>(width) * height * 3);
+}
+
+void SoftwareRenderer::setSun(const SunLight &light) { sun = light; }
+
+void SoftwareRenderer::setMaterial(const SurfaceMaterial &surface) { material = surface; }
+
+void SoftwareRenderer::setBackground(const glm::vec3 &color) { background = color; }
+
+void SoftwareRenderer::setupChunk(int chunkIndex, Span<const float> vertices, std::size_t firstTriangle, std::size_t lastTriangle)
+{
+    Chunk &chunk = chunks[chunkIndex];
+    chunk.triangles.clear();
+    for (std::vector<std::uint32_t> &bin : chunk.bins)
+        bin.clear();
+    chunk.stats = RasterStats();
+    chunk.stats.triangles = lastTriangle - firstTriangle;
+
+    const double halfWidth = 0.5 * width;
+    const double halfHeight = 0.5 * height;
+
+    // Triangle déjà découpé : projection, fonctions d'arête et rangement par tuile
+    auto emit = [&](const ClipVertex &v0, const ClipVertex &v1, const ClipVertex &v2)
+    {
+        const ClipVertex *v[3] = {&v0, &v1, &v2};
+        double sx[3], sy[3], sz[3];
+        float inverseW[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            const double w = v[k]->clip.w;
+            inverseW[k] = static_cast<float>(1.0 / w);
+            sx[k] = (v[k]->clip.x / w + 1.0) * halfWidth;
+            sy[k] = (1.0 - v[k]->clip.y / w) * halfHeight; // Ligne 0 en haut de l'image
+            sz[k] = 0.5 * v[k]->clip.z / w + 0.5;
+        }
+
+        // Pixels dont le centre (x + 0.5, y + 0.5) est dans la boîte englobante
+        const double minX = std::min({sx[0], sx[1], sx[2]});
+        const double maxX = std::max({sx[0], sx[1], sx[2]});
+        const double minY = std::min({sy[0], sy[1], sy[2]});
+        const double maxY = std::max({sy[0], sy[1], sy[2]});
+        const int x0 = static_cast<int>(std::max(std::ceil(minX - 0.5), 0.0));
+        const int x1 = static_cast<int>(std::min(std::floor(maxX - 0.5) + 1, static_cast<double>(width)));
+        const int y0 = static_cast<int>(std::max(std::ceil(minY - 0.5), 0.0));
+        const int y1 = static_cast<int>(std::min(std::floor(maxY - 0.5) + 1, static_cast<double>(height)));
+        double area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sx[2] - sx[0]) * (sy[1] - sy[0]);
+        if (x0 >= x1 || y0 >= y1 || area == 0)
+        {
+            chunk.stats.culled++;
+            return;
+        }
+
+        // Arête k opposée au sommet k, orientée pour être positive à l'intérieur ;
+        // constantes ramenées au coin (x0, y0) de la boîte
+        const double sign = area > 0 ? 1.0 : -1.0;
+        area *= sign;
+        ShadedTriangle triangle;
+        RasterTriangleF &raster = triangle.raster;
+        double depthA = 0, depthB = 0, depthC = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            const int i = (k + 1) % 3;
+            const int j = (k + 2) % 3;
+            const double a = sign * (sy[i] - sy[j]);
+            const double b = sign * (sx[j] - sx[i]);
+            const double c = sign * (sx[i] * sy[j] - sx[j] * sy[i]) + a * x0 + b * y0;
+            raster.edgeA[k] = static_cast<float>(a);
+            raster.edgeB[k] = static_cast<float>(b);
+            raster.edgeC[k] = static_cast<float>(c);
+            // Règle haut-gauche : règle antisymétrique, une arête commune est comptée par un seul triangle
+            raster.bias[k] = (a > 0 || (a == 0 && b < 0)) ? -std::numeric_limits<float>::denorm_min() : 0.0f;
+            depthA += sz[k] * a;
+            depthB += sz[k] * b;
+            depthC += sz[k] * c;
+            triangle.inverseW[k] = inverseW[k];
+            triangle.positions[k] = v[k]->position;
+            triangle.normals[k] = v[k]->normal;
+        }
+        raster.depthA = static_cast<float>(depthA / area);
+        raster.depthB = static_cast<float>(depthB / area);
+        raster.depthC = static_cast<float>(depthC / area);
+        raster.minX = x0;
+        raster.minY = y0;
+        raster.maxX = x1;
+        raster.maxY = y1;
+
+        const std::uint32_t index = static_cast<std::uint32_t>(chunk.triangles.size());
+        chunk.triangles.push_back(triangle);
+        for (int ty = y0 / TILE_SIZE; ty <= (y1 - 1) / TILE_SIZE; ++ty)
+            for (int tx = x0 / TILE_SIZE; tx <= (x1 - 1) / TILE_SIZE; ++tx)
+            {
+                chunk.bins[static_cast<std::size_t>(ty) * tilesX + tx].push_back(index);
+                chunk.stats.binned++;
+            }
+    };
+
+    for (std::size_t t = firstTriangle; t < lastTriangle; ++t)
+    {
+        ClipVertex corners[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            const std::uint32_t vertex = topology.index(3 * t + k);
+            const float *data = vertices.data() + static_cast<std::size_t>(vertex) * VERTEX_POSITION_NORMAL;
+            corners[k] = ClipVertex{clipPositions[vertex], glm::vec3(data[0], data[1], data[2]), glm::vec3(data[3], data[4], data[5])};
+        }
+        if (outsideFrustum(corners[0].clip, corners[1].clip, corners[2].clip))
+        {
+            chunk.stats.culled++;
+            continue;
+        }
+        const bool crossesNear = corners[0].clip.z < -corners[0].clip.w || corners[1].clip.z < -corners[1].clip.w ||
+                                 corners[2].clip.z < -corners[2].clip.w;
+        if (!crossesNear)
+        {
+            emit(corners[0], corners[1], corners[2]);
+            continue;
+        }
+        chunk.stats.clipped++;
+        ClipVertex polygon[4];
+        const int count = clipNear(corners, polygon);
+        for (int k = 2; k < count; ++k)
+            emit(polygon[0], polygon[k - 1], polygon[k]);
+    }
+}
+
+void SoftwareRenderer::renderTile(int tile, const glm::vec3 &eye)
+{
+    const int tx0 = (tile % tilesX) * TILE_SIZE;
+    const int ty0 = (tile / tilesX) * TILE_SIZE;
+    const int tx1 = std::min(tx0 + TILE_SIZE, width);
+    const int ty1 = std::min(ty0 + TILE_SIZE, height);
+    for (int y = ty0; y < ty1; ++y)
+    {
+        std::fill(depth.begin() + y * stride + tx0, depth.begin() + y * stride + tx1, 1.0f);
+        std::fill(ids.begin() + y * stride + tx0, ids.begin() + y * stride + tx1, EMPTY_PIXEL);
+    }
+
+    const RasterTargetF target{depth.data(), ids.data(), stride};
+    for (std::size_t c = 0; c < chunks.size(); ++c)
+    {
+        const Chunk &chunk = chunks[c];
+        for (std::uint32_t index : chunk.bins[tile])
+        {
+            const RasterTriangleF &raster = chunk.triangles[index].raster;
+            rasterTriangleKernel(raster, static_cast<std::uint32_t>(c) << CHUNK_SHIFT | index, target, std::max(tx0, raster.minX),
+                                 std::max(ty0, raster.minY), std::min(tx1, raster.maxX), std::min(ty1, raster.maxY));
+        }
+    }
+
+    // Termes constants du modèle de Phong
+    const glm::vec3 toSun = glm::normalize(sun.position);
+    const glm::vec3 ambient = sun.ambient * material.ambient;
+    const glm::vec3 diffuse = sun.color * sun.intensity * material.diffuse;
+    const glm::vec3 specular = sun.specular * material.specular;
+    for (int y = ty0; y < ty1; ++y)
+    {
+        unsigned char *out = image.data() + (static_cast<std::size_t>(y) * width + tx0) * 3;
+        for (int x = tx0; x < tx1; ++x, out += 3)
+        {
+            const std::uint32_t id = ids[y * stride + x];
+            glm::vec3 color = background;
+            if (id != EMPTY_PIXEL)
+            {
+                const ShadedTriangle &triangle = chunks[id >> CHUNK_SHIFT].triangles[id & ((1u << CHUNK_SHIFT) - 1)];
+                const RasterTriangleF &raster = triangle.raster;
+                const float u = x - raster.minX + 0.5f;
+                const float v = y - raster.minY + 0.5f;
+                // Coordonnées barycentriques de l'écran, puis corrigées de la perspective
+                float weights[3];
+                float total = 0;
+                for (int k = 0; k < 3; ++k)
+                {
+                    weights[k] = std::max(raster.edgeA[k] * u + raster.edgeB[k] * v + raster.edgeC[k], 0.0f) * triangle.inverseW[k];
+                    total += weights[k];
+                }
+                const float scale = total > 0 ? 1.0f / total : 0.0f;
+                glm::vec3 position(0.0f), normal(0.0f);
+                for (int k = 0; k < 3; ++k)
+                {
+                    position += triangle.positions[k] * (weights[k] * scale);
+                    normal += triangle.normals[k] * (weights[k] * scale);
+                }
+                normal = glm::normalize(normal);
+
+                const float lambert = glm::dot(normal, toSun);
+                color = ambient;
+                if (lambert > 0)
+                {
+                    const glm::vec3 halfway = glm::normalize(toSun + glm::normalize(eye - position));
+                    color += diffuse * lambert + specular * std::pow(std::max(glm::dot(normal, halfway), 0.0f), material.shininess);
+                }
+            }
+            out[0] = toByte(color.r);
+            out[1] = toByte(color.g);
+            out[2] = toByte(color.b);
+        }
+    }
+}
+
+Span<const unsigned char> SoftwareRenderer::render(Span<const float> vertices, const glm::mat4 &viewProjection, const glm::vec3 &eye)
+{
+    const std::size_t cells = clipPositions.size();
+    if (vertices.size() != cells * VERTEX_POSITION_NORMAL)
+        throw std::invalid_argument("SoftwareRenderer::render: sommets VERTEX_POSITION_NORMAL de la grille attendus");
+
+    ThreadPool &pool = ThreadPool::shared();
+    const int chunkCount = static_cast<int>(chunks.size());
+    {
+        OCEAN_PROFILE_SCOPE_BYTES(STAGE_BINNING, cells * (VERTEX_POSITION_NORMAL * sizeof(float) + sizeof(glm::vec4)) +
+                                                     topology.indexCount() * topology.indexSize());
+        pool.parallelFor(0, gridSize, pool.grainFor(gridSize), [&](int first, int last)
+        {
+            for (std::size_t i = static_cast<std::size_t>(first) * gridSize; i < static_cast<std::size_t>(last) * gridSize; ++i)
+            {
+                const float *data = vertices.data() + i * VERTEX_POSITION_NORMAL;
+                clipPositions[i] = viewProjection * glm::vec4(data[0], data[1], data[2], 1.0f);
+            }
+        });
+
+        const std::size_t triangles = topology.triangleCount();
+        pool.parallelFor(0, chunkCount, 1, [&](int first, int last)
+        {
+            for (int c = first; c < last; ++c)
+                setupChunk(c, vertices, triangles * c / chunkCount, triangles * (c + 1) / chunkCount);
+        });
+    }
+
+    {
+        OCEAN_PROFILE_SCOPE_BYTES(STAGE_RASTER, static_cast<std::size_t>(width) * height * (sizeof(float) + sizeof(std::uint32_t) + 3));
+        const int tiles = tilesX * tilesY;
+        pool.parallelFor(0, tiles, 1, [&](int first, int last)
+        {
+            for (int tile = first; tile < last; ++tile)
+                renderTile(tile, eye);
+        });
+    }
+
+    frameStats = RasterStats();
+    for (const Chunk &chunk : chunks)
+    {
+        frameStats.triangles += chunk.stats.triangles;
+        frameStats.clipped += chunk.stats.clipped;
+        frameStats.culled += chunk.stats.culled;
+        frameStats.binned += chunk.stats.binned;
+    }
+    return getImage();
+}
+
+int SoftwareRenderer::getWidth() const { return width; }
+
+int SoftwareRenderer::getHeight() const { return height; }
+
+Span<const unsigned char> SoftwareRenderer::getImage() const { return Span<const unsigned char>(image.data(), image.size()); }
+
+const RasterStats &SoftwareRenderer::lastFrame() const { return frameStats; }
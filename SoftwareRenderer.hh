@@ -0,0 +1,112 @@
+#ifndef SOFTWARERENDERER_H
+#define SOFTWARERENDERER_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "MeshTopology.hh"
+#include "SimdKernels.hh"
+#include "Span.hh"
+
+// Soleil directionnel et matériau de la surface, avec les valeurs de
+// setupSunLight et setupOceanMaterial (main.cpp)
+struct SunLight
+{
+    glm::vec3 position = glm::vec3(60.0f, 100.0f, 100.0f); // Direction du soleil vue de la surface
+    glm::vec3 color = glm::vec3(1.0f, 1.0f, 0.8f);
+    float intensity = 1.0f;
+    glm::vec3 ambient = glm::vec3(0.1f);
+    glm::vec3 specular = glm::vec3(1.0f);
+};
+
+struct SurfaceMaterial
+{
+    glm::vec3 ambient = glm::vec3(0.0f, 0.1f, 0.3f);
+    glm::vec3 diffuse = glm::vec3(0.0f, 0.5f, 1.0f);
+    glm::vec3 specular = glm::vec3(1.0f);
+    float shininess = 32.0f;
+};
+
+// Compteurs d'une frame du rendu logiciel
+struct RasterStats
+{
+    std::uint64_t triangles = 0; // Triangles de la topologie
+    std::uint64_t clipped = 0;   // Coupés par le plan proche
+    std::uint64_t culled = 0;    // Hors du champ ou sans aucun centre de pixel
+    std::uint64_t binned = 0;    // Entrées (triangle, tuile)
+};
+
+// Rendu éclairé de la surface sur le CPU, sans contexte OpenGL, pour les
+// machines sans GPU. Les sommets sont ceux de VertexBuilder au format
+// VERTEX_POSITION_NORMAL (en cellules), les triangles ceux de MeshTopology.
+// Trois étapes, chacune répartie sur le pool de threads :
+//   - projection des sommets, puis découpage par le plan proche et
+//     préparation des triangles (fonctions d'arête, plan de profondeur) par
+//     blocs de triangles ; chaque bloc range ses triangles par tuile de
+//     TILE_SIZE x TILE_SIZE pixels, sans verrou ;
+//   - rastérisation de chaque tuile, bloc après bloc dans l'ordre de la
+//     topologie : test de profondeur et identifiant du triangle visible par
+//     pixel (rasterTriangleKernel, 8 pixels par itération en AVX2) ;
+//   - éclairage de Phong (Blinn-Phong, comme le pipeline fixe d'OpenGL) du
+//     seul triangle visible de chaque pixel, normales interpolées en
+//     perspective, puis écriture de l'image RGB.
+// Tous les tampons sont réutilisés d'une frame à l'autre.
+class SoftwareRenderer
+{
+public:
+    static const int TILE_SIZE = 64;
+
+private:
+    struct ShadedTriangle
+    {
+        RasterTriangleF raster;
+        float inverseW[3];
+        glm::vec3 positions[3]; // Espace du maillage, en cellules
+        glm::vec3 normals[3];
+    };
+
+    struct Chunk
+    {
+        std::vector<ShadedTriangle> triangles;
+        std::vector<std::vector<std::uint32_t>> bins; // Par tuile, indices dans triangles
+        RasterStats stats;
+    };
+
+    int width;
+    int height;
+    int gridSize;
+    std::size_t stride; // Pixels par ligne des tampons, multiple de 8
+    int tilesX;
+    int tilesY;
+    const MeshTopology &topology;
+    SunLight sun;
+    SurfaceMaterial material;
+    glm::vec3 background;
+
+    std::vector<glm::vec4> clipPositions;
+    std::vector<Chunk> chunks;
+    std::vector<float> depth;
+    std::vector<std::uint32_t> ids;
+    std::vector<unsigned char> image; // RGB, lignes de haut en bas
+    RasterStats frameStats;
+
+    void setupChunk(int chunk, Span<const float> vertices, std::size_t firstTriangle, std::size_t lastTriangle);
+    void renderTile(int tile, const glm::vec3 &eye);
+
+public:
+    SoftwareRenderer(int width, int height, int gridSize);
+
+    void setSun(const SunLight &light);
+    void setMaterial(const SurfaceMaterial &surface);
+    void setBackground(const glm::vec3 &color);
+
+    // Image de la frame (width * height * 3 octets), valide jusqu'au rendu suivant
+    Span<const unsigned char> render(Span<const float> vertices, const glm::mat4 &viewProjection, const glm::vec3 &eye);
+
+    int getWidth() const;
+    int getHeight() const;
+    Span<const unsigned char> getImage() const;
+    const RasterStats &lastFrame() const;
+};
+
+#endif // SOFTWARERENDERER_H
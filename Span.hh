@@ -0,0 +1,31 @@
+#ifndef SPAN_H
+#define SPAN_H
+
+#include <cstddef>
+#include <type_traits>
+
+// Vue non propriétaire sur un tableau contigu (équivalent minimal de std::span)
+template <typename T>
+class Span
+{
+private:
+    T *ptr;
+    std::size_t count;
+
+public:
+    Span() : ptr(nullptr), count(0) {}
+    Span(T *data, std::size_t size) : ptr(data), count(size) {}
+
+    // Conversion implicite Span<T> -> Span<const T>
+    template <typename U, typename = typename std::enable_if<std::is_convertible<U (*)[], T (*)[]>::value>::type>
+    Span(const Span<U> &other) : ptr(other.data()), count(other.size()) {}
+
+    T *data() const { return ptr; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T &operator[](std::size_t i) const { return ptr[i]; }
+    T *begin() const { return ptr; }
+    T *end() const { return ptr + count; }
+};
+
+#endif // SPAN_H
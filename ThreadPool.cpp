@@ -0,0 +1,160 @@
+#include "ThreadPool.hh"
+
+namespace
+{
+    thread_local bool insideTask = false;
+
+    // Marque le thread appelant comme exécutant une tâche, y compris en cas d'exception
+    struct TaskScope
+    {
+        bool previous;
+        TaskScope() : previous(insideTask) { insideTask = true; }
+        ~TaskScope() { insideTask = previous; }
+    };
+}
+
+ThreadPool::ThreadPool(int threadCount)
+    : task(nullptr), context(nullptr), rangeEnd(0), grain(1), next(0), pending(0), generation(0), stopping(false)
+{
+    start(threadCount);
+}
+
+ThreadPool::~ThreadPool()
+{
+    stop();
+}
+
+void ThreadPool::start(int threadCount)
+{
+    if (threadCount <= 0)
+        threadCount = std::thread::hardware_concurrency();
+    if (threadCount <= 0)
+        threadCount = 1;
+
+    stopping = false;
+    // L'appelant de parallelFor participe au calcul : threadCount - 1 workers
+    for (int i = 1; i < threadCount; ++i)
+        workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+}
+
+void ThreadPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+    workers.clear();
+}
+
+int ThreadPool::getThreadCount() const
+{
+    return static_cast<int>(workers.size()) + 1;
+}
+
+void ThreadPool::setThreadCount(int threadCount)
+{
+    std::lock_guard<std::mutex> lock(dispatchMutex);
+    stop();
+    start(threadCount);
+}
+
+int ThreadPool::grainFor(int count) const
+{
+    const int grainSize = count / (4 * getThreadCount());
+    return grainSize > 0 ? grainSize : 1;
+}
+
+void ThreadPool::workerLoop()
+{
+    insideTask = true;
+    unsigned seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]() { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+        }
+
+        runChunks();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0)
+                done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::runChunks()
+{
+    for (;;)
+    {
+        const int first = next.fetch_add(grain);
+        if (first >= rangeEnd)
+            break;
+        const int last = first + grain < rangeEnd ? first + grain : rangeEnd;
+        try
+        {
+            task(context, first, last);
+        }
+        catch (...)
+        {
+            // Plus aucun bloc n'est distribué ; l'appelant relance la première exception
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error)
+                error = std::current_exception();
+            next.store(rangeEnd);
+            break;
+        }
+    }
+}
+
+void ThreadPool::dispatch(TaskFn fn, void *ctx, int begin, int end, int grainSize)
+{
+    std::lock_guard<std::mutex> dispatchLock(dispatchMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = fn;
+        context = ctx;
+        rangeEnd = end;
+        grain = grainSize;
+        next.store(begin);
+        pending = static_cast<int>(workers.size());
+        error = nullptr;
+        generation++;
+    }
+    wake.notify_all();
+
+    {
+        TaskScope scope;
+        runChunks();
+    }
+
+    // Les workers appellent encore la tâche de l'appelant : attendre même après une exception
+    std::exception_ptr failure;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&]() { return pending == 0; });
+        failure = error;
+        error = nullptr;
+    }
+    if (failure)
+        std::rethrow_exception(failure);
+}
+
+bool ThreadPool::isInsideTask()
+{
+    return insideTask;
+}
+
+ThreadPool &ThreadPool::shared()
+{
+    static ThreadPool pool;
+    return pool;
+}
@@ -0,0 +1,84 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Pool de threads persistants pour les boucles parallèles du calcul.
+// parallelFor découpe [begin, end) en blocs de grain éléments que les threads
+// (y compris l'appelant) se répartissent via un compteur atomique.
+// Aucune allocation par appel : la tâche est passée par pointeur.
+class ThreadPool
+{
+private:
+    typedef void (*TaskFn)(void *context, int first, int last);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::mutex dispatchMutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    TaskFn task;
+    void *context;
+    int rangeEnd;
+    int grain;
+    std::atomic<int> next;
+    int pending;
+    std::exception_ptr error; // Première exception des tâches de l'appel en cours
+    unsigned generation;
+    bool stopping;
+
+    void start(int threadCount);
+    void stop();
+    void workerLoop();
+    void runChunks();
+    void dispatch(TaskFn fn, void *ctx, int begin, int end, int grainSize);
+
+    template <typename Fn>
+    static void invoke(void *ctx, int first, int last)
+    {
+        (*static_cast<Fn *>(ctx))(first, last);
+    }
+
+public:
+    explicit ThreadPool(int threadCount = 0); // 0 : un thread par cœur
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int getThreadCount() const; // Nombre de threads de calcul, appelant compris
+    void setThreadCount(int threadCount);
+
+    // Appelle fn(first, last) sur des sous-intervalles disjoints couvrant [begin, end).
+    // Si fn lève une exception, les blocs restants ne sont pas distribués, les
+    // blocs en cours se terminent et la première exception est relancée ici.
+    template <typename Fn>
+    void parallelFor(int begin, int end, int grainSize, Fn &&fn)
+    {
+        typedef typename std::remove_reference<Fn>::type FnType;
+        if (grainSize < 1)
+            grainSize = 1;
+        if (workers.empty() || end - begin <= grainSize || isInsideTask())
+        {
+            if (begin < end)
+                fn(begin, end);
+            return;
+        }
+        dispatch(&ThreadPool::invoke<FnType>, const_cast<void *>(static_cast<const void *>(&fn)), begin, end, grainSize);
+    }
+
+    // Grain donnant environ quatre blocs par thread pour count éléments
+    int grainFor(int count) const;
+
+    // Vrai pendant l'exécution d'une tâche : les parallelFor imbriqués sont exécutés en série
+    static bool isInsideTask();
+    static ThreadPool &shared(); // Pool commun à la simulation
+};
+
+#endif // THREADPOOL_H
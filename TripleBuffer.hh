@@ -0,0 +1,52 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+// Échange sans verrou entre un producteur et un consommateur : le producteur
+// écrit dans son tampon puis l'échange avec le tampon partagé ; le consommateur
+// échange le sien avec le tampon partagé quand celui-ci contient une frame non
+// lue. Aucun ne bloque l'autre, le consommateur voit toujours la dernière frame
+// publiée, et les frames publiées sans avoir été lues sont perdues.
+template <typename T>
+class TripleBuffer
+{
+private:
+    static const unsigned INDEX_MASK = 3;
+    static const unsigned FRESH = 4; // Le tampon partagé contient une frame non lue
+
+    T slots[3];
+    std::atomic<unsigned> shared; // Index du tampon partagé | FRESH
+    unsigned back;                // Tampon du producteur
+    unsigned front;               // Tampon du consommateur
+
+public:
+    explicit TripleBuffer(const T &initial = T())
+        : slots{initial, initial, initial}, shared(1), back(0), front(2)
+    {
+    }
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    // Producteur : tampon à remplir, puis publish()
+    T &writeBuffer() { return slots[back]; }
+    // Vrai si la frame publiée précédemment n'avait pas été lue (perdue)
+    bool publish()
+    {
+        const unsigned previous = shared.exchange(back | FRESH, std::memory_order_acq_rel);
+        back = previous & INDEX_MASK;
+        return (previous & FRESH) != 0;
+    }
+
+    // Consommateur : passe à la dernière frame publiée ; faux si rien de nouveau
+    bool update()
+    {
+        if ((shared.load(std::memory_order_relaxed) & FRESH) == 0)
+            return false;
+        front = shared.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+    const T &readBuffer() const { return slots[front]; }
+};
+
+#endif // TRIPLEBUFFER_H
@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "heightmap.hh"
+#include "BatchWriter.hh"
+#include "Camera.hh"
+#include "HeightfieldFile.hh"
+#include "Mesh.hh"
+#include "ParameterSweep.hh"
+#include "SoftwareRenderer.hh"
+#include "ThreadPool.hh"
+
+// Générateur de frames hors ligne, sans fenêtre ni OpenGL.
+// Les frames [start, start + count) sont réparties en shardCount blocs
+// contigus : le processus shardIndex ne calcule que le sien. Avec la même
+// graine, chaque frame est identique quel que soit le découpage.
+// En mode balayage (--sweep-grid, --sweep-random), ce sont les états de mer
+// qui sont répartis entre shards, et chacun produit ses frames [start, start + count).
+// Avec --render, chaque frame est une image éclairée de la surface, rendue sur le CPU.
+
+struct BatchOptions
+{
+    int resolution = DEFAULT_RESOLUTION;
+    int start = 0;
+    int count = 100;
+    int shardIndex = 0;
+    int shardCount = 1;
+    unsigned seed = 1;
+    float timeStep = 0.1f;
+    int buffers = 4;
+    std::string output = ".";
+    std::string container; // Fichier conteneur unique au lieu d'une image par frame
+    bool half = false;
+    bool displacements = false;
+    int sweepGrid[4] = {0, 0, 0, 0}; // Vitesses de vent, directions, choppiness, tailles de domaine
+    int sweepRandom = 0;
+    int renderWidth = 0; // Images rendues (--render) au lieu des hauteurs
+    int renderHeight = 0;
+    float cameraPosition[3] = {-1, -1, -1}; // En cellules ; négatif : au-dessus du bord du domaine
+    float pruneThreshold = 0; // Part d'énergie du spectre que l'élagage peut écarter
+};
+
+bool parseRender(const std::string &value, BatchOptions &options)
+{
+    std::istringstream stream(value);
+    char separator = 0;
+    stream >> options.renderWidth >> separator >> options.renderHeight;
+    return stream && stream.eof() && separator == 'x' && options.renderWidth > 0 && options.renderHeight > 0;
+}
+
+bool parseCamera(const std::string &value, BatchOptions &options)
+{
+    std::istringstream stream(value);
+    char comma[2];
+    stream >> options.cameraPosition[0] >> comma[0] >> options.cameraPosition[1] >> comma[1] >> options.cameraPosition[2];
+    return stream && stream.eof() && comma[0] == ',' && comma[1] == ',';
+}
+
+bool parseSweepGrid(const std::string &value, BatchOptions &options)
+{
+    std::istringstream stream(value);
+    char comma[3];
+    stream >> options.sweepGrid[0] >> comma[0] >> options.sweepGrid[1] >> comma[1] >> options.sweepGrid[2] >> comma[2] >>
+        options.sweepGrid[3];
+    if (!stream || !stream.eof() || comma[0] != ',' || comma[1] != ',' || comma[2] != ',')
+        return false;
+    return std::min({options.sweepGrid[0], options.sweepGrid[1], options.sweepGrid[2], options.sweepGrid[3]}) > 0;
+}
+
+bool parseShard(const std::string &value, BatchOptions &options)
+{
+    const std::size_t slash = value.find('/');
+    if (slash == std::string::npos)
+        return false;
+    options.shardIndex = std::atoi(value.substr(0, slash).c_str());
+    options.shardCount = std::atoi(value.substr(slash + 1).c_str());
+    return options.shardCount > 0 && options.shardIndex >= 0 && options.shardIndex < options.shardCount;
+}
+
+bool parseArguments(int argc, char **argv, BatchOptions &options)
+{
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        const std::string option = argv[i];
+        const std::string value = argv[++i];
+        if (option == "--threads")
+            ThreadPool::shared().setThreadCount(std::atoi(value.c_str()));
+        else if (option == "--resolution")
+            options.resolution = std::atoi(value.c_str());
+        else if (option == "--start")
+            options.start = std::atoi(value.c_str());
+        else if (option == "--count")
+            options.count = std::atoi(value.c_str());
+        else if (option == "--seed")
+            options.seed = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        else if (option == "--dt")
+            options.timeStep = static_cast<float>(std::atof(value.c_str()));
+        else if (option == "--buffers")
+            options.buffers = std::atoi(value.c_str());
+        else if (option == "--output")
+            options.output = value;
+        else if (option == "--container")
+            options.container = value;
+        else if (option == "--format")
+        {
+            if (value != "f32" && value != "f16")
+            {
+                std::cerr << "Option --format invalide : f32 ou f16 attendu" << std::endl;
+                return false;
+            }
+            options.half = value == "f16";
+        }
+        else if (option == "--displacements")
+            options.displacements = std::atoi(value.c_str()) != 0;
+        else if (option == "--sweep-grid")
+        {
+            if (!parseSweepGrid(value, options))
+            {
+                std::cerr << "Option --sweep-grid invalide : vents,directions,choppiness,domaines (entiers > 0) attendus" << std::endl;
+                return false;
+            }
+        }
+        else if (option == "--render")
+        {
+            if (!parseRender(value, options))
+            {
+                std::cerr << "Option --render invalide : LARGEURxHAUTEUR attendu" << std::endl;
+                return false;
+            }
+        }
+        else if (option == "--camera")
+        {
+            if (!parseCamera(value, options))
+            {
+                std::cerr << "Option --camera invalide : x,y,z attendu" << std::endl;
+                return false;
+            }
+        }
+        else if (option == "--prune")
+            options.pruneThreshold = static_cast<float>(std::atof(value.c_str()));
+        else if (option == "--sweep-random")
+            options.sweepRandom = std::atoi(value.c_str());
+        else if (option == "--shard")
+        {
+            if (!parseShard(value, options))
+            {
+                std::cerr << "Option --shard invalide : i/n avec 0 <= i < n attendu" << std::endl;
+                return false;
+            }
+        }
+        else
+        {
+            std::cerr << "Option inconnue : " << option << std::endl;
+            return false;
+        }
+    }
+
+    if (!isSupportedResolution(options.resolution))
+    {
+        std::cerr << "Résolution non supportée : puissance de deux entre "
+                  << MIN_RESOLUTION << " et " << MAX_RESOLUTION << " attendue" << std::endl;
+        return false;
+    }
+    if (options.start < 0 || options.count < 0)
+    {
+        std::cerr << "--start et --count doivent être positifs" << std::endl;
+        return false;
+    }
+    if (options.sweepRandom < 0 || (options.sweepRandom > 0 && options.sweepGrid[0] > 0))
+    {
+        std::cerr << "--sweep-random N (N > 0) et --sweep-grid sont exclusifs" << std::endl;
+        return false;
+    }
+    if (!(options.pruneThreshold >= 0 && options.pruneThreshold < 1))
+    {
+        std::cerr << "--prune doit être compris dans [0, 1)" << std::endl;
+        return false;
+    }
+    if (options.renderWidth > 0 && (!options.container.empty() || options.sweepRandom > 0 || options.sweepGrid[0] > 0))
+    {
+        std::cerr << "--render n'est disponible ni avec --container ni en mode balayage" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Bloc [first, last) de ce shard parmi count éléments : les premiers shards prennent le reste de la division
+void shardRange(const BatchOptions &options, int offset, int count, int &first, int &last)
+{
+    const int share = count / options.shardCount;
+    const int extra = count % options.shardCount;
+    first = offset + options.shardIndex * share + std::min(options.shardIndex, extra);
+    last = first + share + (options.shardIndex < extra ? 1 : 0);
+}
+
+int runSweep(const BatchOptions &options)
+{
+    const std::vector<SeaState> all = options.sweepRandom > 0
+                                          ? sweepRandom(options.sweepRandom, options.seed)
+                                          : sweepGrid(options.sweepGrid[0], options.sweepGrid[1], options.sweepGrid[2],
+                                                      options.sweepGrid[3], options.seed);
+    int first, last;
+    shardRange(options, 0, static_cast<int>(all.size()), first, last);
+    std::vector<SeaState> seaStates(all.begin() + first, all.begin() + last);
+    for (SeaState &seaState : seaStates)
+        seaState.parameters.pruneThreshold = options.pruneThreshold;
+
+    SweepStats stats;
+    try
+    {
+        const ParameterSweep sweep(options.resolution, options.start, options.count, options.timeStep);
+        SweepContainerSink sink(options.output, seaStates, options.resolution, options.half ? HEIGHTFIELD_FLOAT16 : HEIGHTFIELD_FLOAT32,
+                                options.displacements, options.start, options.count, options.timeStep);
+        BatchWriter writer(sink, options.resolution, options.displacements, options.buffers);
+        stats = sweep.run(seaStates, writer);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "États de mer " << first << " à " << last - 1 << " (shard " << options.shardIndex << "/" << options.shardCount
+              << ") : " << stats.frames << " frames en " << stats.seconds << " s, " << stats.framesPerSecond
+              << " frames d'états de mer par seconde" << std::endl;
+    return 0;
+}
+
+void writeFrames(const BatchOptions &options, const OceanParameters &parameters, OceanStateF &state, int first, int last)
+{
+    std::unique_ptr<FrameSink> sink;
+    const bool withDisplacements = !options.container.empty() && options.displacements;
+    if (options.container.empty())
+        sink.reset(new PPMFrameSink(options.output, options.resolution));
+    else
+        sink.reset(new HeightfieldWriter(options.container,
+                                         makeHeightfieldHeader(options.resolution, options.half ? HEIGHTFIELD_FLOAT16 : HEIGHTFIELD_FLOAT32,
+                                                               withDisplacements, options.seed, options.timeStep, parameters)));
+
+    BatchWriter writer(*sink, options.resolution, withDisplacements, options.buffers);
+    for (int frame = first; frame < last; ++frame)
+    {
+        // Calcul exact à t = frame * dt : le résultat ne dépend pas du découpage en shards
+        UpdateHeights(frame * options.timeStep, state);
+        writer.push(frame, state.heights(), state.displacements());
+    }
+    writer.finish();
+    if (HeightfieldWriter *container = dynamic_cast<HeightfieldWriter *>(sink.get()))
+        container->close();
+}
+
+void renderFrames(const BatchOptions &options, OceanStateF &state, int first, int last)
+{
+    // Caméra de main.cpp, par défaut au-dessus du bord z = resolution du domaine et tournée vers lui
+    const float resolution = static_cast<float>(options.resolution);
+    Camera camera(options.cameraPosition[0] < 0 ? resolution * 0.5f : options.cameraPosition[0],
+                  options.cameraPosition[1] < 0 ? resolution * 0.35f : options.cameraPosition[1],
+                  options.cameraPosition[2] < 0 ? resolution * 1.05f : options.cameraPosition[2]);
+    camera.init();
+    const glm::mat4 viewProjection =
+        camera.projectionMatrix(static_cast<float>(options.renderWidth) / options.renderHeight, 0.5f, 4 * resolution) * camera.viewMatrix();
+    const glm::vec3 eye(camera.getX(), camera.getY(), camera.getZ());
+
+    VertexBuilder builder(options.resolution, PATCH_SIZE / options.resolution, CHOPPINESS, VERTEX_POSITION_NORMAL);
+    SoftwareRenderer renderer(options.renderWidth, options.renderHeight, options.resolution);
+    ImageWriter writer(options.output, options.renderWidth, options.renderHeight, options.buffers);
+    for (int frame = first; frame < last; ++frame)
+    {
+        UpdateHeights(frame * options.timeStep, state);
+        // Plage de cette frame plutôt que celle de la précédente : l'image ne dépend pas du découpage
+        builder.measureRange(state.heights());
+        writer.push(frame, renderer.render(builder.build(state.heights(), state.displacements(), state.slopes()), viewProjection, eye));
+    }
+    writer.finish();
+}
+
+int main(int argc, char **argv)
+{
+    BatchOptions options;
+    if (!parseArguments(argc, argv, options))
+        return 1;
+    if (options.sweepRandom > 0 || options.sweepGrid[0] > 0)
+        return runSweep(options);
+
+    int first, last;
+    shardRange(options, options.start, options.count, first, last);
+
+    OceanParameters parameters;
+    parameters.pruneThreshold = options.pruneThreshold;
+    OceanStateF state(options.resolution);
+    GenerateSpectra(state, options.seed, parameters);
+
+    const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    try
+    {
+        if (options.renderWidth > 0)
+            renderFrames(options, state, first, last);
+        else
+            writeFrames(options, parameters, state, first, last);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::cout << "Frames " << first << " à " << last - 1 << " (shard " << options.shardIndex << "/" << options.shardCount
+              << ") : " << last - first << " images en " << seconds << " s" << std::endl;
+    if (options.pruneThreshold > 0)
+    {
+        const OceanStateF::SpectrumPruning &pruning = state.spectrumPruning();
+        std::cout << "Élagage : " << 100.0 * pruning.activeCells / state.cellCount() << " % des cellules évoluées, énergie écartée "
+                  << pruning.discardedEnergy << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,365 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "heightmap.hh"
+#include "AllocationCounter.hh"
+#include "Camera.hh"
+#include "Mesh.hh"
+#include "MeshTopology.hh"
+#include "ModalEvaluator.hh"
+#include "OceanCascades.hh"
+#include "OceanSampler.hh"
+#include "SimdKernels.hh"
+#include "SoftwareRenderer.hh"
+#include "ThreadPool.hh"
+
+// Mesures hors fenêtre des étapes de la simulation et du maillage, en JSON sur
+// la sortie standard : médiane et p99 du temps par appel, allocations par appel
+// et débit en octets par seconde (octets lus et écrits par un appel, estimés).
+
+struct BenchResult
+{
+    std::string name;
+    int resolution;
+    int iterations;
+    double medianNs;
+    double p99Ns;
+    double meanNs;
+    double allocationsPerCall;
+    double bytesPerCall;
+};
+
+// UpdateHeights sur un spectre élagué (OceanParameters::pruneThreshold)
+struct PruningResult
+{
+    int resolution;
+    float threshold;
+    double activeCells;    // Part des cellules évoluées
+    int activeRows;        // Lignes transformées en première passe
+    double discardedEnergy;
+    std::string name;      // Cas correspondant dans results
+};
+
+struct BenchOptions
+{
+    std::vector<int> resolutions = {64, 128, 256, 512, 1024, 2048};
+    double minSeconds = 0.2; // Durée minimale de mesure par cas
+    int minIterations = 5;
+    int maxIterations = 1000;
+    std::string filter;      // Ne garde que les cas dont le nom contient ce texte
+    std::string scratchFile = "bench_heightmap.ppm";
+};
+
+// Un appel d'échauffement, puis des appels chronométrés un par un
+BenchResult runBenchmark(const BenchOptions &options, const std::string &name, int resolution, double bytesPerCall,
+                         const std::function<void()> &fn)
+{
+    fn();
+
+    std::vector<double> samples;
+    samples.reserve(options.maxIterations); // Pas d'allocation du banc pendant la mesure
+    const std::uint64_t allocationsBefore = totalAllocationCount();
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    while (static_cast<int>(samples.size()) < options.maxIterations &&
+           (static_cast<int>(samples.size()) < options.minIterations || elapsed < options.minSeconds))
+    {
+        const std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+        fn();
+        const std::chrono::steady_clock::time_point after = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::nano>(after - before).count());
+        elapsed = std::chrono::duration<double>(after - start).count();
+    }
+    const std::uint64_t allocations = totalAllocationCount() - allocationsBefore;
+
+    std::vector<double> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    const std::size_t count = sorted.size();
+    double total = 0;
+    for (double sample : sorted)
+        total += sample;
+
+    BenchResult result;
+    result.name = name;
+    result.resolution = resolution;
+    result.iterations = static_cast<int>(count);
+    result.medianNs = count % 2 ? sorted[count / 2] : 0.5 * (sorted[count / 2 - 1] + sorted[count / 2]);
+    result.p99Ns = sorted[std::min(count - 1, static_cast<std::size_t>(0.99 * (count - 1) + 0.5))];
+    result.meanNs = total / count;
+    result.allocationsPerCall = static_cast<double>(allocations) / count;
+    result.bytesPerCall = bytesPerCall;
+    return result;
+}
+
+void runResolution(const BenchOptions &options, int resolution, std::vector<BenchResult> &results, std::vector<PruningResult> &pruning)
+{
+    const double cells = static_cast<double>(resolution) * resolution;
+    const double complexBytes = cells * sizeof(std::complex<float>);
+    const double realBytes = cells * sizeof(float);
+    OceanStateF state(resolution);
+    GenerateSpectra(state, 1u);
+    UpdateHeights(0.0f, state);
+
+    std::vector<std::complex<float>> matrix(state.spectrum().begin(), state.spectrum().end());
+    std::vector<float> heights(state.heights().begin(), state.heights().end());
+    const Span<const float> heightsView(heights.data(), heights.size());
+    float t = 0.0f;
+
+    auto add = [&](const std::string &name, double bytes, const std::function<void()> &fn)
+    {
+        if (name.find(options.filter) != std::string::npos)
+            results.push_back(runBenchmark(options, name, resolution, bytes, fn));
+    };
+
+    // Octets par appel : chaque tampon lu ou écrit compté une fois (hors passes internes de la FFT)
+    add("GenerateSpectra", 4 * complexBytes + realBytes, [&]
+    {
+        GenerateSpectra(state, 1u);
+    });
+    add("UpdateHeights", 10 * complexBytes + 3 * realBytes, [&]
+    {
+        UpdateHeights(t, state);
+        t += 0.1f;
+    });
+    // Spectre élagué : moins de cellules évoluées et de lignes transformées, même nombre d'octets nominal
+    for (float threshold : {1e-4f, 1e-3f, 1e-2f})
+    {
+        OceanParameters parameters;
+        parameters.pruneThreshold = threshold;
+        OceanStateF pruned(resolution);
+        GenerateSpectra(pruned, 1u, parameters);
+        std::ostringstream name;
+        name << "UpdateHeights(prune " << threshold << ")";
+        const OceanStateF::SpectrumPruning &stats = pruned.spectrumPruning();
+        pruning.push_back(PruningResult{resolution, threshold, static_cast<double>(stats.activeCells) / cells, stats.activeRows,
+                                        stats.discardedEnergy, name.str()});
+        add(name.str(), 10 * complexBytes + 3 * realBytes, [&]
+        {
+            UpdateHeights(t, pruned);
+            t += 0.1f;
+        });
+    }
+    // Cascades : une IFFT groupée de 4 champs par cascade puis la combinaison, coût attendu linéaire
+    for (int count : {2, 4})
+    {
+        OceanCascades cascades(resolution, count);
+        cascades.generate(1u);
+        add("OceanCascades::update(" + std::to_string(count) + ")", count * (10 * complexBytes + 3 * realBytes), [&]
+        {
+            cascades.update(t);
+            t += 0.1f;
+        });
+    }
+    add("InverseFourierTransform2D", 2 * complexBytes, [&]
+    {
+        InverseFourierTransform2D(Span<std::complex<float>>(matrix.data(), matrix.size()), resolution);
+    });
+    add("normalizeHeightMap", 3 * realBytes, [&]
+    {
+        std::copy(state.heights().begin(), state.heights().end(), heights.begin());
+        normalizeHeightMap(Span<float>(heights.data(), heights.size()));
+    });
+    add("convertToVertices", realBytes + 3 * realBytes, [&]
+    {
+        std::vector<float> vertices = convertToVertices(heightsView, resolution);
+    });
+    VertexBuilder builder(resolution, PATCH_SIZE / resolution, CHOPPINESS, VERTEX_POSITION_NORMAL);
+    add("VertexBuilder::build", realBytes + 2 * complexBytes + 6 * realBytes, [&]
+    {
+        builder.build(state.heights(), state.displacements(), state.slopes());
+    });
+    // Image éclairée 1024x1024 du domaine vu de son bord, comme ocean_batch --render : profondeur, identifiants et pixels écrits
+    {
+        const Span<const float> vertices = builder.build(state.heights(), state.displacements(), state.slopes());
+        Camera camera(resolution * 0.5f, resolution * 0.35f, resolution * 1.05f);
+        camera.init();
+        const glm::mat4 viewProjection = camera.projectionMatrix(1.0f, 0.5f, 4.0f * resolution) * camera.viewMatrix();
+        SoftwareRenderer renderer(1024, 1024, resolution);
+        add("SoftwareRenderer::render(1024x1024)", 1024.0 * 1024 * (sizeof(float) + sizeof(std::uint32_t) + 3), [&]
+        {
+            renderer.render(vertices, viewProjection, glm::vec3(camera.getX(), camera.getY(), camera.getZ()));
+        });
+    }
+    // Requêtes de hauteur en des points aléatoires du domaine : x et z lus, h écrite (12 octets par point)
+    const std::size_t samplePoints = 1 << 20;
+    std::vector<float> sampleX(samplePoints), sampleZ(samplePoints), sampleHeights(samplePoints);
+    std::mt19937 sampleRandom(1u);
+    std::uniform_real_distribution<float> sampleCoordinate(-PATCH_SIZE, 2 * PATCH_SIZE);
+    for (std::size_t i = 0; i < samplePoints; ++i)
+    {
+        sampleX[i] = sampleCoordinate(sampleRandom);
+        sampleZ[i] = sampleCoordinate(sampleRandom);
+    }
+    const OceanSampler sampler(state);
+    auto sampleAll = [&](SampleFilter filter, int iterations)
+    {
+        sampler.sample(Span<const float>(sampleX.data(), samplePoints), Span<const float>(sampleZ.data(), samplePoints),
+                       Span<float>(sampleHeights.data(), samplePoints), filter, iterations);
+    };
+    add("OceanSampler::sample(bilinear)", 12.0 * samplePoints, [&] { sampleAll(SAMPLE_BILINEAR, 0); });
+    add("OceanSampler::sample(bicubic)", 12.0 * samplePoints, [&] { sampleAll(SAMPLE_BICUBIC, 0); });
+    add("OceanSampler::sample(bilinear, 2 iterations)", 12.0 * samplePoints, [&] { sampleAll(SAMPLE_BILINEAR, 2); });
+    // Quelques centaines de points (bouée, physique d'un navire) sommés sur les 256 modes les plus énergétiques
+    const std::size_t probePoints = 256;
+    ModalEvaluator modal(state, 256);
+    modal.setBreakEven(std::numeric_limits<std::size_t>::max());
+    add("ModalEvaluator::evaluate(256 modes)", 12.0 * probePoints, [&]
+    {
+        modal.evaluate(t, Span<const float>(sampleX.data(), probePoints), Span<const float>(sampleZ.data(), probePoints),
+                       Span<float>(sampleHeights.data(), probePoints));
+        t += 0.001f;
+    });
+    add("generateIndices", 6.0 * (resolution - 1) * (resolution - 1) * sizeof(unsigned int), [&]
+    {
+        std::vector<unsigned int> indices = generateIndices(resolution, resolution);
+    });
+    add("MeshTopology(bands)", 6.0 * (resolution - 1) * (resolution - 1) * (resolution <= 128 ? 2 : 4), [&]
+    {
+        MeshTopology topology(resolution, TOPOLOGY_BANDS);
+    });
+
+    // writePPM annonce chaque image sur std::cout : sortie détournée pour garder un JSON valide
+    std::ostringstream discard;
+    std::streambuf *stdoutBuffer = std::cout.rdbuf(discard.rdbuf());
+    add("writePPM", realBytes + 3 * cells, [&]
+    {
+        writePPM(options.scratchFile, heightsView, resolution);
+        discard.str(std::string());
+    });
+    std::cout.rdbuf(stdoutBuffer);
+    std::remove(options.scratchFile.c_str());
+
+    // Référence récursive d'origine, pour comparer avec la FFT itérative
+    if (resolution <= 512)
+    {
+        CMatrix reference(resolution, CVector(resolution));
+        add("InverseFourierTransform2DReference", 2 * cells * sizeof(Complex), [&]
+        {
+            InverseFourierTransform2DReference(reference);
+        });
+    }
+}
+
+bool parseArguments(int argc, char **argv, BenchOptions &options)
+{
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        const std::string option = argv[i];
+        const std::string value = argv[++i];
+        if (option == "--threads")
+            ThreadPool::shared().setThreadCount(std::atoi(value.c_str()));
+        else if (option == "--resolutions")
+        {
+            // Liste séparée par des virgules, par exemple 128,512
+            options.resolutions.clear();
+            std::istringstream list(value);
+            std::string item;
+            while (std::getline(list, item, ','))
+                options.resolutions.push_back(std::atoi(item.c_str()));
+        }
+        else if (option == "--min-time")
+            options.minSeconds = std::atof(value.c_str());
+        else if (option == "--max-iterations")
+            options.maxIterations = std::max(1, std::atoi(value.c_str()));
+        else if (option == "--filter")
+            options.filter = value;
+        else
+        {
+            std::cerr << "Option inconnue : " << option << std::endl;
+            return false;
+        }
+    }
+
+    for (int resolution : options.resolutions)
+    {
+        if (!isSupportedResolution(resolution))
+        {
+            std::cerr << "Résolution non supportée : " << resolution << std::endl;
+            return false;
+        }
+    }
+    options.minIterations = std::min(options.minIterations, options.maxIterations);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions options;
+    if (!parseArguments(argc, argv, options))
+        return 1;
+
+    std::vector<BenchResult> results;
+    std::vector<PruningResult> pruning;
+    for (int resolution : options.resolutions)
+    {
+        std::cerr << "Résolution " << resolution << "..." << std::endl;
+        runResolution(options, resolution, results, pruning);
+    }
+
+    std::cout << "{\n  \"simd\": \"" << simdKernelName() << "\",\n  \"threads\": " << ThreadPool::shared().getThreadCount()
+              << ",\n  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchResult &r = results[i];
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "    {\"name\": \"%s\", \"resolution\": %d, \"iterations\": %d, \"median_ns\": %.0f, \"p99_ns\": %.0f, "
+                      "\"mean_ns\": %.0f, \"allocations_per_call\": %.2f, \"bytes_per_call\": %.0f, \"bytes_per_second\": %.4g}",
+                      r.name.c_str(), r.resolution, r.iterations, r.medianNs, r.p99Ns, r.meanNs, r.allocationsPerCall,
+                      r.bytesPerCall, r.bytesPerCall / (r.medianNs * 1e-9));
+        std::cout << line << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    std::cout << "  ],\n";
+
+    // Dispositions des indices : taille et sommets transformés par triangle (cache FIFO simulé)
+    std::cout << "  \"topology\": [\n";
+    const TopologyLayout layouts[] = {TOPOLOGY_ROWS, TOPOLOGY_STRIPS, TOPOLOGY_BANDS};
+    for (std::size_t r = 0; r < options.resolutions.size(); ++r)
+    {
+        for (std::size_t l = 0; l < 3; ++l)
+        {
+            const MeshTopology topology(options.resolutions[r], layouts[l]);
+            char line[512];
+            std::snprintf(line, sizeof(line),
+                          "    {\"resolution\": %d, \"layout\": \"%s\", \"indices\": %zu, \"index_bytes\": %zu, "
+                          "\"acmr_fifo16\": %.4f, \"acmr_fifo32\": %.4f}",
+                          topology.getSize(), MeshTopology::layoutName(layouts[l]), topology.indexCount(),
+                          topology.indexCount() * topology.indexSize(), simulateACMR(topology, 16), simulateACMR(topology, 32));
+            std::cout << line << (r + 1 < options.resolutions.size() || l + 1 < 3 ? ",\n" : "\n");
+        }
+    }
+    std::cout << "  ],\n";
+
+    // Élagage : énergie écartée et gain mesuré par rapport à UpdateHeights (0 si l'un des deux cas est filtré)
+    std::cout << "  \"pruning\": [\n";
+    for (std::size_t p = 0; p < pruning.size(); ++p)
+    {
+        const PruningResult &r = pruning[p];
+        double full = 0;
+        double pruned = 0;
+        for (const BenchResult &result : results)
+        {
+            if (result.resolution != r.resolution)
+                continue;
+            if (result.name == "UpdateHeights")
+                full = result.medianNs;
+            else if (result.name == r.name)
+                pruned = result.medianNs;
+        }
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "    {\"resolution\": %d, \"threshold\": %g, \"active_cells\": %.4f, \"active_rows\": %d, "
+                      "\"discarded_energy\": %.3g, \"speedup\": %.3f}",
+                      r.resolution, r.threshold, r.activeCells, r.activeRows, r.discardedEnergy, pruned > 0 ? full / pruned : 0.0);
+        std::cout << line << (p + 1 < pruning.size() ? ",\n" : "\n");
+    }
+    std::cout << "  ]\n}" << std::endl;
+    return 0;
+}
@@ -4,63 +4,25 @@
 #include <random>
 #include <iostream>
 #include <fstream>
-#include <iomanip>
-
-typedef std::complex<double> Complex;
-typedef std::vector<Complex> CVector;
-typedef std::vector<std::vector<Complex>> CMatrix;
-
-constexpr float WIND_SPEED_MIN = 2.0;
-constexpr float WIND_SPEED_MAX = 12.0;
-constexpr float PATCH_SIZE_MIN = 64.0;
-constexpr float PATCH_SIZE_MAX = 256.0;
-constexpr float CHOPPINESS_MIN = 0.5;
-constexpr float CHOPPINESS_MAX = 1.5;
-constexpr int RESOLUTION = 128;
-
-constexpr float GRAVITY = 9.81f;
-constexpr float WIND_SPEED = 12.4956;
-constexpr float PATCH_SIZE = 128;
-constexpr float CHOPPINESS = 1.01701;
-
-struct Vector2
-{
-    double x, y;
-
-    Vector2(double _x, double _y) : x(_x), y(_y) {}
-
-    Vector2 operator*(double a) const { return Vector2(x * a, y * a); }
-    double dot(const Vector2 &other) const { return x * other.x + y * other.y; }
-    double magnitude() const { return sqrt(x * x + y * y); }
-
-    Vector2 normalize() const
-    {
-        double mag = magnitude();
-        return Vector2(x / mag, y / mag);
-    }
-};
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include "heightmap.hh"
+#include "FFTPlan.hh"
+#include "SimdKernels.hh"
+#include "ThreadPool.hh"
+#include "BatchWriter.hh"
+#include "Profiler.hh"
 
 Vector2 WIND_DIRECTION = Vector2(-1, -1).normalize();
 
-float RandomGaussian()
+float PhillipsSpectrumCoefs(const Vector2 &k, float windSpeed, const Vector2 &windDirection)
 {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::normal_distribution<float> dist(0.0f, 1.0f);
-    return dist(gen);
-}
-
-Complex ExpI(float theta)
-{
-    return Complex(cos(theta), sin(theta));
-}
-
-float PhillipsSpectrumCoefs(const Vector2 &k)
-{
-    float L = WIND_SPEED * WIND_SPEED / GRAVITY;
+    float L = windSpeed * windSpeed / GRAVITY;
     float l = L / 300.0f;
 
-    float kDotw = k.dot(WIND_DIRECTION);
+    float kDotw = k.dot(windDirection);
     float k2 = k.dot(k);
     if (k2 < 0.000001f)
         return 0;
@@ -73,20 +35,208 @@ float PhillipsSpectrumCoefs(const Vector2 &k)
     return phillips * expf(-k2 * l * l);
 }
 
-void GenerateSpectra(std::vector<Complex> &spectrum0, std::vector<float> &angularSpeeds)
+// Le tirage de la cellule (i, j) ne dépend que de (seed, i, j) : les lignes
+// sont réparties entre les threads sans changer le résultat.
+template <typename Real, int RESOLUTION>
+void generateSpectra(BasicOceanState<Real> &state, unsigned seed, const SpectrumBand &band, const OceanParameters &parameters)
 {
-    for (int i = 0; i < RESOLUTION; i++)
+    typedef std::complex<Real> ComplexT;
+    Span<ComplexT> spectrum0 = state.spectrum0();
+    Span<ComplexT> spectrum0Mirror = state.spectrum0Mirror();
+    Span<ComplexT> directions = state.directions();
+    Span<ComplexT> waveVectors = state.waveVectors();
+    Span<Real> angularSpeeds = state.angularSpeeds();
+    ThreadPool &pool = ThreadPool::shared();
+    const int grain = pool.grainFor(RESOLUTION);
+    // La variance d'un mode est proportionnelle à l'aire Δk² = (2π / patchSize)² d'une
+    // cellule du spectre : les cascades de tailles différentes décrivent la même mer
+    const float amplitudeScale = PATCH_SIZE / band.patchSize;
+
+    pool.parallelFor(0, RESOLUTION, grain, [&](int first, int last)
     {
-        for (int j = 0; j < RESOLUTION; j++)
+        for (int i = first; i < last; i++)
         {
-            Vector2 k = Vector2(M_PI / PATCH_SIZE * (RESOLUTION - 2 * i), M_PI / PATCH_SIZE * (RESOLUTION - 2 * j));
-            float p = sqrt(PhillipsSpectrumCoefs(k) / 2);
+            ComplexT *row = spectrum0.data() + i * RESOLUTION;
+            gaussianRowKernel(seed, i, 0, RESOLUTION, row);
+            for (int j = 0; j < RESOLUTION; j++)
+            {
+                Vector2 k = Vector2(M_PI / band.patchSize * (RESOLUTION - 2 * i), M_PI / band.patchSize * (RESOLUTION - 2 * j));
+                const double magnitude = k.magnitude();
+                const bool inBand = magnitude >= band.minWaveNumber && magnitude < band.maxWaveNumber;
+                float p = inBand ? amplitudeScale * sqrt(PhillipsSpectrumCoefs(k, parameters.windSpeed, parameters.windDirection) / 2) : 0.0f;
+
+                row[j] *= p;
+                angularSpeeds[i * RESOLUTION + j] = sqrt(GRAVITY * k.magnitude());
+                // Sur les lignes de Nyquist (i = 0 ou j = 0), -k et k sont la même
+                // cellule : la composante correspondante est annulée pour que les
+                // spectres dérivés restent hermitiens
+                waveVectors[i * RESOLUTION + j] = ComplexT(i == 0 ? 0 : k.x, j == 0 ? 0 : k.y);
+            }
+        }
+    });
 
-            int index = i * RESOLUTION + j;
-            spectrum0[index] = Complex(RandomGaussian() * p, RandomGaussian() * p);
-            angularSpeeds[index] = sqrt(GRAVITY * k.magnitude());
+    // Données constantes de l'évolution temporelle, calculées une fois ici plutôt qu'à chaque frame
+    pool.parallelFor(0, RESOLUTION, grain, [&](int first, int last)
+    {
+        for (int x = first; x < last; x++)
+        {
+            for (int y = 0; y < RESOLUTION; y++)
+            {
+                int i = y + x * RESOLUTION;
+                // -k est rangé en ((RESOLUTION - x) % RESOLUTION, (RESOLUTION - y) % RESOLUTION) :
+                // h(k, t) est alors exactement hermitien et son IFFT réelle
+                const int mirror = (RESOLUTION - y) % RESOLUTION + (RESOLUTION - x) % RESOLUTION * RESOLUTION;
+                spectrum0Mirror[i] = std::conj(spectrum0[mirror]);
+
+                // Au centre du spectre (k = 0), pas de direction : on évite le NaN de normalize()
+                Vector2 k = Vector2(RESOLUTION * .5f - x, RESOLUTION * .5f - y);
+                k = k.magnitude() > 0 ? k.normalize() : k;
+                directions[i] = ComplexT(x == 0 ? 0 : k.x, y == 0 ? 0 : k.y);
+            }
         }
+    });
+}
+
+// Élagage du spectre. La cellule k et son opposée -k ont la même énergie de
+// paire |h0(k)|² + |h0(-k)|² : elles sont gardées ou écartées ensemble, et
+// h(k, t) reste hermitien. Les paires les plus faibles sont annulées tant que
+// leur énergie cumulée reste sous threshold fois l'énergie totale (les cellules
+// nulles le sont toujours). Chaque demi-ligne ne garde que l'intervalle de ses
+// cellules non nulles, arrondi à des multiples de 8 colonnes pour que les
+// noyaux vectoriels traitent les mêmes paquets de cellules qu'avant l'élagage.
+template <typename Real, int RESOLUTION>
+void pruneSpectrum(BasicOceanState<Real> &state, float threshold)
+{
+    const int HALF = RESOLUTION / 2;
+    const int ALIGN = 8;
+    const std::size_t cells = state.cellCount();
+    Span<std::complex<Real>> spectrum0 = state.spectrum0();
+    Span<std::complex<Real>> spectrum0Mirror = state.spectrum0Mirror();
+    std::vector<Real> pairEnergy(cells);
+    double total = 0;
+    for (std::size_t i = 0; i < cells; ++i)
+    {
+        pairEnergy[i] = std::norm(spectrum0[i]) + std::norm(spectrum0Mirror[i]);
+        total += std::norm(spectrum0[i]);
     }
+
+    // Sur un groupe de paires d'énergie e, la somme des |h0|² vaut e / 2 par cellule
+    Real cutoff = 0;
+    if (threshold > 0 && total > 0)
+    {
+        std::vector<Real> sorted(pairEnergy);
+        std::sort(sorted.begin(), sorted.end());
+        const double budget = threshold * total;
+        double discarded = 0;
+        for (std::size_t i = 0; i < cells;)
+        {
+            std::size_t j = i;
+            double group = 0;
+            for (; j < cells && sorted[j] == sorted[i]; ++j)
+                group += 0.5 * sorted[j];
+            if (discarded + group > budget)
+                break;
+            discarded += group;
+            cutoff = sorted[i];
+            i = j;
+        }
+    }
+
+    typename BasicOceanState<Real>::SpectrumPruning &pruning = state.spectrumPruning();
+    Span<int> spans = state.activeSpans();
+    Span<unsigned char> rows = state.activeRows();
+    double discarded = 0;
+    pruning.activeCells = 0;
+    pruning.activeRows = 0;
+    for (int row = 0; row < RESOLUTION; ++row)
+    {
+        bool active = false;
+        for (int half = 0; half < 2; ++half)
+        {
+            const int column = half * HALF;
+            int first = column + HALF;
+            int last = column;
+            for (int j = column; j < column + HALF; ++j)
+            {
+                const std::size_t index = static_cast<std::size_t>(row) * RESOLUTION + j;
+                if (pairEnergy[index] <= cutoff)
+                {
+                    discarded += std::norm(spectrum0[index]);
+                    spectrum0[index] = spectrum0Mirror[index] = 0;
+                    continue;
+                }
+                first = std::min(first, j);
+                last = j + 1;
+            }
+            if (first < last)
+            {
+                first = column + (first - column) / ALIGN * ALIGN;
+                last = std::min(column + (last - column + ALIGN - 1) / ALIGN * ALIGN, column + HALF);
+                pruning.activeCells += last - first;
+                active = true;
+            }
+            else
+                first = last = column;
+            spans[4 * row + 2 * half] = first;
+            spans[4 * row + 2 * half + 1] = last;
+        }
+        // Les spectres sont rangés décalés de RESOLUTION / 2 (voir shiftedFields)
+        rows[(row + HALF) % RESOLUTION] = active;
+        pruning.activeRows += active;
+    }
+    pruning.threshold = threshold;
+    pruning.discardedEnergy = total > 0 ? discarded / total : 0.0;
+}
+
+template <typename Real>
+void generateSpectra(BasicOceanState<Real> &state, unsigned seed, const SpectrumBand &band, const OceanParameters &parameters)
+{
+    if (!(band.patchSize > 0) || !(band.minWaveNumber < band.maxWaveNumber))
+        throw std::invalid_argument("GenerateSpectra: bande invalide");
+    if (!(parameters.windSpeed > 0) || !(std::fabs(parameters.windDirection.magnitude() - 1) < 1e-3))
+        throw std::invalid_argument("GenerateSpectra: vent invalide");
+    if (!(parameters.pruneThreshold >= 0 && parameters.pruneThreshold < 1))
+        throw std::invalid_argument("GenerateSpectra: seuil d'élagage hors de [0, 1)");
+
+    state.setChoppiness(parameters.choppiness);
+    state.setPatchSize(band.patchSize);
+    dispatchResolution(state.getResolution(), [&](auto size)
+    {
+        generateSpectra<Real, decltype(size)::value>(state, seed, band, parameters);
+        pruneSpectrum<Real, decltype(size)::value>(state, parameters.pruneThreshold);
+    });
+}
+
+template <typename Real>
+void GenerateSpectra(BasicOceanState<Real> &state, unsigned seed, const SpectrumBand &band)
+{
+    generateSpectra(state, seed, band, OceanParameters());
+}
+
+template <typename Real>
+void GenerateSpectra(BasicOceanState<Real> &state, unsigned seed, const SpectrumBand &band, const OceanParameters &parameters)
+{
+    generateSpectra(state, seed, band, parameters);
+}
+
+template <typename Real>
+void GenerateSpectra(BasicOceanState<Real> &state, unsigned seed, const OceanParameters &parameters)
+{
+    SpectrumBand band;
+    band.patchSize = parameters.patchSize;
+    generateSpectra(state, seed, band, parameters);
+}
+
+template <typename Real>
+void GenerateSpectra(BasicOceanState<Real> &state, unsigned seed)
+{
+    GenerateSpectra(state, seed, SpectrumBand());
+}
+
+template <typename Real>
+void GenerateSpectra(BasicOceanState<Real> &state)
+{
+    GenerateSpectra(state, std::random_device()());
 }
 
 void inverseFastFourierTransform(CVector &x)
@@ -117,7 +267,8 @@ void inverseFastFourierTransform(CVector &x)
     }
 }
 
-void InverseFourierTransform2D(CMatrix &matrix)
+// Version récursive d'origine, conservée comme référence de précision
+void InverseFourierTransform2DReference(CMatrix &matrix)
 {
     const int rows = matrix.size();
     const int cols = matrix[0].size();
@@ -153,144 +304,571 @@ void InverseFourierTransform2D(CMatrix &matrix)
     }
 }
 
-void UpdateHeights(float t, std::vector<Complex> &spectrum0, std::vector<Complex> &spectrum, std::vector<Complex> &choppinesses, std::vector<Complex> &choppinessDisplacements, std::vector<float> &heights, std::vector<float> &angularSpeeds)
+// Transposition en place de count matrices carrées, par tuiles de TILE x TILE
+// pour que les deux tuiles échangées restent dans le cache L1
+template <typename Real, int SIZE>
+void transposeTiled(std::complex<Real> *const *matrices, int count)
 {
-    CMatrix spectrumMatrix(RESOLUTION, std::vector<Complex>(RESOLUTION));
-    CMatrix choppinessMatrix(RESOLUTION, std::vector<Complex>(RESOLUTION));
+    const int TILE = 32;
+    const int tiles = (SIZE + TILE - 1) / TILE;
 
-    for (int x = 0; x < RESOLUTION; x++)
+    // Chaque tâche traite une ligne de tuiles d'une matrice, à partir de la diagonale
+    ThreadPool::shared().parallelFor(0, count * tiles, 1, [&](int firstTile, int lastTile)
     {
-        for (int y = 0; y < RESOLUTION; y++)
+        for (int task = firstTile; task < lastTile; ++task)
         {
-            int i = y + x * RESOLUTION;
-            float wt = angularSpeeds[i] * t;
-            Complex h = spectrum0[i];
-            Complex h1;
-            if (y == 0 && x == 0)
-                h1 = spectrum0[RESOLUTION * RESOLUTION - 1];
-            else if (y == 0)
-                h1 = spectrum0[RESOLUTION - 1 + (RESOLUTION - x) * RESOLUTION];
-            else if (x == 0)
-                h1 = spectrum0[RESOLUTION - y + (RESOLUTION - x - 1) * RESOLUTION];
-            else
-                h1 = spectrum0[(RESOLUTION - y) + (RESOLUTION - x) * RESOLUTION];
-
-            Vector2 k = Vector2(RESOLUTION * .5f - x, RESOLUTION * .5f - y).normalize();
-            Complex spec = h * ExpI(wt) + std::conj(h1) * ExpI(-wt);
-            spectrumMatrix[x][y] = spec;
-            choppinessMatrix[x][y] = Complex(k.y, -k.x) * spec;
+            std::complex<Real> *matrix = matrices[task / tiles];
+            const int bi = task % tiles;
+            const int i0 = bi * TILE;
+            const int i1 = std::min(i0 + TILE, SIZE);
+            for (int bj = bi; bj < tiles; ++bj)
+            {
+                const int j0 = bj * TILE;
+                const int j1 = std::min(j0 + TILE, SIZE);
+                for (int i = i0; i < i1; ++i)
+                {
+                    for (int j = (bi == bj) ? i + 1 : j0; j < j1; ++j)
+                    {
+                        std::swap(matrix[i * SIZE + j], matrix[j * SIZE + i]);
+                    }
+                }
+            }
         }
+    });
+}
+
+// IFFT 2D complète de count matrices carrées, normalisées par SIZE * SIZE, sans
+// troncature à la partie réelle. Chaque étape (lignes, transposition, colonnes)
+// traite toutes les matrices dans un seul parallelFor : une synchronisation du
+// pool par étape, quel que soit le nombre de champs.
+// activeRows (facultatif) : par matrice, ses lignes non nulles ; la première
+// passe saute les autres, dont la transformée est nulle.
+template <typename Real, int SIZE>
+void inverseFourierTransform2DBatch(std::complex<Real> *const *matrices, int count, const unsigned char *const *activeRows = nullptr)
+{
+    typedef std::complex<Real> ComplexT;
+    const BasicFFTPlan<Real> &plan = BasicFFTPlan<Real>::get(SIZE);
+    ThreadPool &pool = ThreadPool::shared();
+    const int grain = pool.grainFor(count * SIZE);
+
+    // Inverse transform along the rows
+    {
+        OCEAN_PROFILE_SCOPE_BYTES(STAGE_IFFT_ROWS, 2 * sizeof(ComplexT) * SIZE * SIZE * count);
+        pool.parallelFor(0, count * SIZE, grain, [&](int first, int last)
+        {
+            for (int i = first; i < last; ++i)
+            {
+                if (!activeRows || activeRows[i / SIZE][i % SIZE])
+                    plan.inverse(matrices[i / SIZE] + (i % SIZE) * SIZE);
+            }
+        });
+    }
+
+    // Inverse transform along the columns
+    {
+        OCEAN_PROFILE_SCOPE_BYTES(STAGE_IFFT_TRANSPOSE, 2 * sizeof(ComplexT) * SIZE * SIZE * count);
+        transposeTiled<Real, SIZE>(matrices, count);
+    }
+    const Real scale = Real(1) / (Real(SIZE) * SIZE);
+    {
+        OCEAN_PROFILE_SCOPE_BYTES(STAGE_IFFT_COLUMNS, 2 * sizeof(ComplexT) * SIZE * SIZE * count);
+        pool.parallelFor(0, count * SIZE, grain, [&](int first, int last)
+        {
+            for (int i = first; i < last; ++i)
+            {
+                ComplexT *row = matrices[i / SIZE] + (i % SIZE) * SIZE;
+                plan.inverse(row);
+                for (int j = 0; j < SIZE; ++j)
+                {
+                    row[j] *= scale;
+                }
+            }
+        });
+    }
+    OCEAN_PROFILE_SCOPE_BYTES(STAGE_IFFT_TRANSPOSE, 2 * sizeof(ComplexT) * SIZE * SIZE * count);
+    transposeTiled<Real, SIZE>(matrices, count);
+}
+
+template <typename Real, int SIZE>
+void inverseFourierTransform2DComplex(Span<std::complex<Real>> matrix)
+{
+    std::complex<Real> *const matrices[1] = {matrix.data()};
+    inverseFourierTransform2DBatch<Real, SIZE>(matrices, 1);
+}
+
+template <typename Real>
+void InverseFourierTransform2D(Span<std::complex<Real>> matrix, int size)
+{
+    dispatchResolution(size, [&](auto fixedSize)
+    {
+        inverseFourierTransform2DComplex<Real, decltype(fixedSize)::value>(matrix);
+    });
+
+    for (std::complex<Real> &value : matrix)
+    {
+        value = std::real(value);
     }
+}
 
-    InverseFourierTransform2D(spectrumMatrix);
-    InverseFourierTransform2D(choppinessMatrix);
+// Re(IFFT(a)) ne dépend que de la partie hermitienne (a[k] + conj(a[-k])) / 2.
+// Les deux parties hermitiennes ont une IFFT réelle : on les transforme ensemble
+// sous la forme a + i b, puis on sépare partie réelle et partie imaginaire.
+// En sortie, a contient Re(IFFT(a)) + i Re(IFFT(b)) : résultat identique à deux
+// appels à InverseFourierTransform2D, pour le coût d'un seul.
+template <typename Real, int SIZE>
+void inverseFourierTransform2DPacked(Span<std::complex<Real>> a, Span<std::complex<Real>> b)
+{
+    typedef std::complex<Real> ComplexT;
+    ThreadPool &pool = ThreadPool::shared();
 
-    for (int i = 0; i < RESOLUTION; i++)
+    // Empaquetage en place, par paires (k, -k) : chaque paire est traitée par
+    // la ligne de son premier élément, aucun élément n'est partagé entre tâches
     {
-        for (int j = 0; j < RESOLUTION; j++)
+        OCEAN_PROFILE_SCOPE_BYTES(STAGE_IFFT_PACK, 3 * sizeof(ComplexT) * SIZE * SIZE);
+        pool.parallelFor(0, SIZE, pool.grainFor(SIZE), [&](int first, int last)
         {
-            float sign = ((i + j) % 2) ? -1 : 1;
-            int index = i * RESOLUTION + j;
-            heights[index] = sign * spectrumMatrix[i][j].real();
-            choppinessDisplacements[index] = Complex(sign * choppinessMatrix[i][j].real(), sign * choppinessMatrix[i][j].imag());
-        }
+            for (int i = first; i < last; ++i)
+            {
+                const int mi = (SIZE - i) % SIZE;
+                for (int j = 0; j < SIZE; ++j)
+                {
+                    const int mj = (SIZE - j) % SIZE;
+                    const int p = i * SIZE + j;
+                    const int m = mi * SIZE + mj;
+                    if (m < p)
+                        continue;
+
+                    const ComplexT ha = Real(0.5) * (a[p] + std::conj(a[m]));
+                    const ComplexT hb = Real(0.5) * (b[p] + std::conj(b[m]));
+                    a[p] = ha + ComplexT(-hb.imag(), hb.real());
+                    a[m] = std::conj(ha) + ComplexT(hb.imag(), hb.real());
+                }
+            }
+        });
     }
+
+    inverseFourierTransform2DComplex<Real, SIZE>(a);
 }
 
-void normalizeHeightMap(CMatrix &heightMap)
+template <typename Real>
+void InverseFourierTransform2DPacked(Span<std::complex<Real>> a, Span<std::complex<Real>> b, int size)
 {
-    double min = std::numeric_limits<double>::max();
-    double max = std::numeric_limits<double>::lowest();
+    dispatchResolution(size, [&](auto fixedSize)
+    {
+        inverseFourierTransform2DPacked<Real, decltype(fixedSize)::value>(a, b);
+    });
+}
+
+// Sorties de l'évolution pour les cellules [column, column + RESOLUTION / 2) de
+// la ligne row. Les spectres sont rangés décalés de RESOLUTION / 2 sur les deux
+// axes : l'IFFT donne alors directement les champs, sans le signe (-1)^(i + j)
+// de la grille centrée.
+template <typename Real, int RESOLUTION>
+SpectralFields<Real> shiftedFields(BasicOceanState<Real> &state, int row, int column)
+{
+    const int half = RESOLUTION / 2;
+    const std::size_t index = static_cast<std::size_t>((row + half) % RESOLUTION) * RESOLUTION + (column + half) % RESOLUTION;
+    return SpectralFields<Real>{state.spectrum().data() + index, state.displacements().data() + index,
+                                state.slopes().data() + index, state.jacobianSpectrum().data() + index};
+}
 
-    const int size = heightMap.size();
-    for (int i = 0; i < size; ++i)
+// Annule count cellules des quatre spectres
+template <typename Real>
+void clearFields(const SpectralFields<Real> &fields, int count)
+{
+    std::fill(fields.heights, fields.heights + count, std::complex<Real>());
+    std::fill(fields.displacements, fields.displacements + count, std::complex<Real>());
+    std::fill(fields.slopes, fields.slopes + count, std::complex<Real>());
+    std::fill(fields.jacobian, fields.jacobian + count, std::complex<Real>());
+}
+
+// Ligne row du spectre : evolve(begin, count, fields) sur les colonnes actives
+// de chaque demi-ligne (begin : indice de la première dans les données de
+// l'état), les autres cellules des spectres de sortie sont annulées
+template <typename Real, int RESOLUTION, typename Evolve>
+void evolveActiveRow(BasicOceanState<Real> &state, int row, Evolve &&evolve)
+{
+    const int *spans = state.activeSpans().data() + 4 * row;
+    for (int half = 0; half < 2; ++half)
     {
-        for (int j = 0; j < size; ++j)
+        const int column = half * RESOLUTION / 2;
+        const int first = spans[2 * half];
+        const int last = spans[2 * half + 1];
+        clearFields(shiftedFields<Real, RESOLUTION>(state, row, column), first - column);
+        if (first < last)
+            evolve(static_cast<std::size_t>(row) * RESOLUTION + first, last - first, shiftedFields<Real, RESOLUTION>(state, row, first));
+        clearFields(shiftedFields<Real, RESOLUTION>(state, row, last), column + RESOLUTION / 2 - last);
+    }
+}
+
+// IFFT groupée des quatre spectres de chaque état, puis dépliage des hauteurs
+// et du jacobien. Déplacements et pentes sont transformés en place dans leurs
+// buffers définitifs. Chaque étape traite tous les états en un seul parallelFor.
+template <typename Real, int RESOLUTION>
+void finishHeights(BasicOceanState<Real> *const *states, int count)
+{
+    typedef std::complex<Real> ComplexT;
+    ThreadPool &pool = ThreadPool::shared();
+
+    ComplexT *fields[4 * MAX_CASCADES];
+    const unsigned char *activeRows[4 * MAX_CASCADES];
+    for (int c = 0; c < count; ++c)
+    {
+        fields[4 * c] = states[c]->spectrum().data();
+        fields[4 * c + 1] = states[c]->displacements().data();
+        fields[4 * c + 2] = states[c]->slopes().data();
+        fields[4 * c + 3] = states[c]->jacobianSpectrum().data();
+        std::fill(activeRows + 4 * c, activeRows + 4 * c + 4, states[c]->activeRows().data());
+    }
+    inverseFourierTransform2DBatch<Real, RESOLUTION>(fields, 4 * count, activeRows);
+
+    {
+        OCEAN_PROFILE_SCOPE_BYTES(STAGE_UNPACK, (2 * sizeof(ComplexT) + 2 * sizeof(Real)) * RESOLUTION * RESOLUTION * count);
+        pool.parallelFor(0, count * RESOLUTION, pool.grainFor(count * RESOLUTION), [&](int first, int last)
         {
-            const double value = std::abs(heightMap[i][j].real());
-            if (value < min)
-                min = value;
-            if (value > max)
-                max = value;
-        }
+            for (int task = first; task < last; ++task)
+            {
+                BasicOceanState<Real> &state = *states[task / RESOLUTION];
+                const Real lambda = state.getChoppiness();
+                const ComplexT *spectrumMatrix = state.spectrum().data();
+                const ComplexT *jacobianMatrix = state.jacobianSpectrum().data();
+                Real *heights = state.heights().data();
+                Real *jacobian = state.jacobian().data();
+                const std::size_t begin = static_cast<std::size_t>(task % RESOLUTION) * RESOLUTION;
+                for (std::size_t index = begin; index < begin + RESOLUTION; index++)
+                {
+                    // x' = x + lambda D : J = (1 + lambda dDx/dx)(1 + lambda dDz/dz) - (lambda dDx/dz)^2
+                    const ComplexT h = spectrumMatrix[index];
+                    const ComplexT j = jacobianMatrix[index];
+                    heights[index] = h.real();
+                    jacobian[index] = (1 + lambda * j.real()) * (1 + lambda * j.imag()) - lambda * lambda * h.imag() * h.imag();
+                }
+            }
+        });
     }
+}
 
-    const double range = max - min;
-    const double newMin = 0.25;
-    const double newMax = 0.75;
-    const double newRange = newMax - newMin;
+template <typename Real, int RESOLUTION>
+void updateHeights(float t, BasicOceanState<Real> *const *states, int count)
+{
+    ThreadPool &pool = ThreadPool::shared();
 
-    for (int i = 0; i < size; ++i)
     {
-        for (int j = 0; j < size; ++j)
+        OCEAN_PROFILE_SCOPE_BYTES(STAGE_EVOLVE, (8 * sizeof(std::complex<Real>) + sizeof(Real)) * RESOLUTION * RESOLUTION * count);
+        pool.parallelFor(0, count * RESOLUTION, pool.grainFor(count * RESOLUTION), [&](int first, int last)
+        {
+            for (int task = first; task < last; ++task)
+            {
+                BasicOceanState<Real> &state = *states[task / RESOLUTION];
+                evolveActiveRow<Real, RESOLUTION>(state, task % RESOLUTION, [&](std::size_t begin, int cells, const SpectralFields<Real> &fields)
+                {
+                    evolveSpectrumKernel(t, cells, state.spectrum0().data() + begin, state.spectrum0Mirror().data() + begin,
+                                         state.angularSpeeds().data() + begin, state.directions().data() + begin,
+                                         state.waveVectors().data() + begin, fields);
+                });
+            }
+        });
+    }
+
+    finishHeights<Real, RESOLUTION>(states, count);
+}
+
+// Cascades : de 1 à MAX_CASCADES états de même résolution
+template <typename Real>
+void checkCascades(Span<BasicOceanState<Real> *const> states)
+{
+    if (states.empty() || states.size() > static_cast<std::size_t>(MAX_CASCADES))
+        throw std::invalid_argument("Cascades : de 1 à MAX_CASCADES états attendus");
+    for (BasicOceanState<Real> *state : states)
+    {
+        if (state->getResolution() != states[0]->getResolution())
+            throw std::invalid_argument("Cascades : les états doivent avoir la même résolution");
+    }
+}
+
+template <typename Real>
+void UpdateHeights(float t, Span<BasicOceanState<Real> *const> states)
+{
+    checkCascades(states);
+    dispatchResolution(states[0]->getResolution(), [&](auto size)
+    {
+        updateHeights<Real, decltype(size)::value>(t, states.data(), static_cast<int>(states.size()));
+    });
+
+    // Un appel exact repositionne l'horloge à pas fixe juste après t
+    for (BasicOceanState<Real> *state : states)
+    {
+        typename BasicOceanState<Real>::RotorClock &clock = state->rotorClock();
+        if (clock.enabled)
         {
-            const double value = std::abs(heightMap[i][j].real());
-            const double normalizedValue = ((value - min) / range) * newRange + newMin;
-            heightMap[i][j] = Complex(normalizedValue, 0.0);
+            clock.time = t + clock.step;
+            clock.stepsSinceResync = clock.resyncInterval;
         }
     }
 }
 
-void writePPM(const std::string &filename, const CMatrix &heightMap)
+template <typename Real>
+void UpdateHeights(float t, BasicOceanState<Real> &state)
 {
-    const int size = heightMap.size();
-    std::ofstream file(filename, std::ios::binary);
+    BasicOceanState<Real> *const states[1] = {&state};
+    UpdateHeights(t, Span<BasicOceanState<Real> *const>(states, 1));
+}
+
+// w(k) arrondi au multiple le plus proche de 2π / period : chaque onde
+// effectue un nombre entier d'oscillations et la surface boucle exactement.
+template <typename Real>
+void QuantizeDispersion(BasicOceanState<Real> &state, float period)
+{
+    if (!(period > 0))
+        throw std::invalid_argument("QuantizeDispersion: la période doit être positive");
+
+    const double baseFrequency = 2.0 * M_PI / period;
+    for (Real &omega : state.angularSpeeds())
+    {
+        omega = static_cast<Real>(std::round(omega / baseFrequency) * baseFrequency);
+    }
+}
+
+// Rotors exp(iw dt) calculés en double : l'erreur d'arrondi par pas reste
+// au niveau du float et le recalage périodique empêche la dérive.
+template <typename Real>
+void SetupPhaseRotors(BasicOceanState<Real> &state, float t0, float dt, int resyncInterval)
+{
+    Span<const Real> omega = state.angularSpeeds();
+    Span<std::complex<Real>> rotors = state.rotors();
+    for (std::size_t i = 0; i < rotors.size(); ++i)
+    {
+        rotors[i] = std::complex<Real>(std::polar(1.0, static_cast<double>(omega[i]) * dt));
+    }
+
+    typename BasicOceanState<Real>::RotorClock &clock = state.rotorClock();
+    clock.enabled = true;
+    clock.time = t0;
+    clock.step = dt;
+    clock.resyncInterval = std::max(resyncInterval, 1);
+    clock.stepsSinceResync = clock.resyncInterval; // Force un calcul exact au premier pas
+}
+
+template <typename Real, int RESOLUTION>
+void stepHeights(BasicOceanState<Real> *const *states, int count)
+{
+    ThreadPool &pool = ThreadPool::shared();
+    const int grain = pool.grainFor(count * RESOLUTION);
+
+    {
+        OCEAN_PROFILE_SCOPE_BYTES(STAGE_EVOLVE, 11 * sizeof(std::complex<Real>) * RESOLUTION * RESOLUTION * count);
+        pool.parallelFor(0, count * RESOLUTION, grain, [&](int first, int last)
+        {
+            for (int task = first; task < last; ++task)
+            {
+                BasicOceanState<Real> &state = *states[task / RESOLUTION];
+                const typename BasicOceanState<Real>::RotorClock &clock = state.rotorClock();
+                const bool resync = clock.stepsSinceResync >= clock.resyncInterval;
+                const double time = clock.time;
+                evolveActiveRow<Real, RESOLUTION>(state, task % RESOLUTION, [&](std::size_t begin, int cells, const SpectralFields<Real> &fields)
+                {
+                    std::complex<Real> *phases = state.phases().data() + begin;
+                    if (resync)
+                    {
+                        const Real *omega = state.angularSpeeds().data() + begin;
+                        for (int i = 0; i < cells; ++i)
+                        {
+                            phases[i] = std::complex<Real>(std::polar(1.0, static_cast<double>(omega[i]) * time));
+                        }
+                    }
+                    evolveRotorKernel(cells, state.spectrum0().data() + begin, state.spectrum0Mirror().data() + begin,
+                                      phases, state.rotors().data() + begin, state.directions().data() + begin,
+                                      state.waveVectors().data() + begin, fields);
+                });
+            }
+        });
+    }
+
+    finishHeights<Real, RESOLUTION>(states, count);
+
+    for (int c = 0; c < count; ++c)
+    {
+        typename BasicOceanState<Real>::RotorClock &clock = states[c]->rotorClock();
+        clock.stepsSinceResync = clock.stepsSinceResync >= clock.resyncInterval ? 1 : clock.stepsSinceResync + 1;
+        clock.time += clock.step;
+    }
+}
+
+template <typename Real>
+void StepHeights(Span<BasicOceanState<Real> *const> states)
+{
+    checkCascades(states);
+    for (BasicOceanState<Real> *state : states)
+    {
+        if (!state->rotorClock().enabled)
+            throw std::logic_error("StepHeights: SetupPhaseRotors doit être appelé avant");
+    }
+
+    dispatchResolution(states[0]->getResolution(), [&](auto size)
+    {
+        stepHeights<Real, decltype(size)::value>(states.data(), static_cast<int>(states.size()));
+    });
+}
+
+template <typename Real>
+void StepHeights(BasicOceanState<Real> &state)
+{
+    BasicOceanState<Real> *const states[1] = {&state};
+    StepHeights(Span<BasicOceanState<Real> *const>(states, 1));
+}
 
+// Normalise |h| dans [0.25, 0.75], en place
+template <typename Real>
+void normalizeHeightMap(Span<Real> heightMap)
+{
+    OCEAN_PROFILE_SCOPE_BYTES(STAGE_NORMALIZE, 3 * sizeof(Real) * heightMap.size());
+    Real min = std::numeric_limits<Real>::max();
+    Real max = std::numeric_limits<Real>::lowest();
+    absMinMaxKernel(heightMap.data(), heightMap.size(), min, max);
+
+    const Real range = max - min;
+    const Real newMin = 0.25;
+    const Real newMax = 0.75;
+    const Real scale = (newMax - newMin) / range;
+    scaleAbsKernel(heightMap.data(), heightMap.size(), scale, newMin - min * scale);
+}
+
+template <typename Real>
+void encodePPMImpl(Span<const Real> heightMap, int size, std::vector<unsigned char> &bytes)
+{
     // En-tête du fichier PPM
-    file << "P6\n"
-         << size << " " << size << "\n255\n";
+    std::ostringstream header;
+    header << "P6\n"
+           << size << " " << size << "\n255\n";
+    const std::string head = header.str();
+
+    bytes.resize(head.size() + 3 * static_cast<std::size_t>(size) * size);
+    std::copy(head.begin(), head.end(), bytes.begin());
 
     // Données de l'image
+    unsigned char *out = bytes.data() + head.size();
     for (int i = size - 1; i >= 0; --i)
     {
         for (int j = 0; j < size; ++j)
         {
-            const unsigned char pixel = static_cast<unsigned char>(std::abs(heightMap[i][j].real()) * 255.0);
-            file.put(pixel).put(pixel).put(pixel);
+            const unsigned char pixel = static_cast<unsigned char>(std::abs(heightMap[i * size + j]) * 255.0);
+            out[0] = out[1] = out[2] = pixel;
+            out += 3;
         }
     }
+}
 
-    std::cout << "Image PPM enregistrée : " << filename << std::endl;
+void encodePPM(Span<const float> heightMap, int size, std::vector<unsigned char> &bytes)
+{
+    encodePPMImpl(heightMap, size, bytes);
+}
+
+void encodePPM(Span<const double> heightMap, int size, std::vector<unsigned char> &bytes)
+{
+    encodePPMImpl(heightMap, size, bytes);
+}
+
+template <typename Real>
+void writePPMImpl(const std::string &filename, Span<const Real> heightMap, int size)
+{
+    // Image encodée en mémoire puis écrite en une seule fois
+    std::vector<unsigned char> bytes;
+    encodePPM(heightMap, size, bytes);
+    std::ofstream file(filename, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+
+    std::cout << "Image PPM enregistrée : " << filename << '\n';
+}
+
+void writePPM(const std::string &filename, Span<const float> heightMap, int size)
+{
+    writePPMImpl(filename, heightMap, size);
+}
+
+void writePPM(const std::string &filename, Span<const double> heightMap, int size)
+{
+    writePPMImpl(filename, heightMap, size);
 }
 
-CMatrix make_heightmap(int nb_img, int iter = 0)
+CMatrix make_heightmap(int nb_img, int iter, int resolution)
 {
-    std::vector<Complex> spectrum0(RESOLUTION * RESOLUTION);
-    std::vector<Complex> spectrum(RESOLUTION * RESOLUTION);
-    std::vector<Complex> choppinesses(RESOLUTION * RESOLUTION);
-    std::vector<Complex> choppinessDisplacements(RESOLUTION * RESOLUTION);
-    std::vector<float> heights(RESOLUTION * RESOLUTION);
-    std::vector<float> angularSpeeds(RESOLUTION * RESOLUTION);
-    CMatrix heightMap(RESOLUTION, std::vector<Complex>(RESOLUTION));
+    OceanStateF state(resolution);
     // Génère le spectre initial
-    GenerateSpectra(spectrum0, angularSpeeds);
+    GenerateSpectra(state);
 
-    // Génère les images pour chaque instant de temps
+    // Génère les images pour chaque instant de temps, t = i * 0.1
+    SetupPhaseRotors(state, 0.0f, 0.1f);
+    PPMFrameSink images("", resolution);
+    BatchWriter writer(images, resolution);
     for (int i = 0; i < nb_img; ++i)
     {
-        // Met à jour les hauteurs après un certain temps
-        float t = i * 0.1f;
-        UpdateHeights(t, spectrum0, spectrum, choppinesses, choppinessDisplacements, heights, angularSpeeds);
+        StepHeights(state);
+
+        // Enregistrer l'image (normalisée et écrite pendant le calcul de la suivante)
+        writer.push(nb_img == 1 ? iter : i, state.heights());
+    }
+    writer.finish();
+    normalizeHeightMap(state.heights());
 
-        // Convertir les hauteurs en une matrice 2D
-        for (int i = 0; i < RESOLUTION; ++i)
+    // Convertir les hauteurs en une matrice 2D
+    CMatrix heightMap(resolution, std::vector<Complex>(resolution));
+    Span<const float> heights = state.heights();
+    for (int i = 0; i < resolution; ++i)
+    {
+        for (int j = 0; j < resolution; ++j)
         {
-            for (int j = 0; j < RESOLUTION; ++j)
-            {
-                heightMap[i][j] = Complex(heights[i * RESOLUTION + j], 0.0);
-            }
+            heightMap[i][j] = Complex(heights[i * resolution + j], 0.0);
         }
-
-        normalizeHeightMap(heightMap);
-        // Enregistrer l'image
-        std::ostringstream filenameStream;
-        if (nb_img == 1)
-            filenameStream << "heightmap_" << std::setfill('0') << std::setw(4) << static_cast<int>(iter) << ".ppm";
-        else
-            filenameStream << "heightmap_" << std::setfill('0') << std::setw(4) << static_cast<int>(i) << ".ppm";
-        std::string filename = filenameStream.str();
-        writePPM(filename, heightMap);
     }
 
     return heightMap;
-}
\ No newline at end of file
+}
+
+float heightmap_value(float x, float z, const CMatrix &heightmap)
+{
+    const int size = static_cast<int>(heightmap.size());
+    if (size == 0)
+        throw std::invalid_argument("heightmap_value: grille vide");
+
+    // Interpolation bilinéaire périodique de la partie réelle, x selon les lignes
+    const float fx = std::floor(x);
+    const float fz = std::floor(z);
+    const float tx = x - fx;
+    const float tz = z - fz;
+    const int i0 = ((static_cast<int>(fx) % size) + size) % size;
+    const int j0 = ((static_cast<int>(fz) % size) + size) % size;
+    const int i1 = (i0 + 1) % size;
+    const int j1 = (j0 + 1) % size;
+    const double r0 = heightmap[i0][j0].real() + tz * (heightmap[i0][j1].real() - heightmap[i0][j0].real());
+    const double r1 = heightmap[i1][j0].real() + tz * (heightmap[i1][j1].real() - heightmap[i1][j0].real());
+    return static_cast<float>(r0 + tx * (r1 - r0));
+}
+
+template void GenerateSpectra(BasicOceanState<float> &state);
+template void GenerateSpectra(BasicOceanState<double> &state);
+template void GenerateSpectra(BasicOceanState<float> &state, unsigned seed);
+template void GenerateSpectra(BasicOceanState<double> &state, unsigned seed);
+template void GenerateSpectra(BasicOceanState<float> &state, unsigned seed, const SpectrumBand &band);
+template void GenerateSpectra(BasicOceanState<double> &state, unsigned seed, const SpectrumBand &band);
+template void GenerateSpectra(BasicOceanState<float> &state, unsigned seed, const OceanParameters &parameters);
+template void GenerateSpectra(BasicOceanState<double> &state, unsigned seed, const OceanParameters &parameters);
+template void GenerateSpectra(BasicOceanState<float> &state, unsigned seed, const SpectrumBand &band, const OceanParameters &parameters);
+template void GenerateSpectra(BasicOceanState<double> &state, unsigned seed, const SpectrumBand &band, const OceanParameters &parameters);
+template void UpdateHeights(float t, BasicOceanState<float> &state);
+template void UpdateHeights(float t, BasicOceanState<double> &state);
+template void UpdateHeights(float t, Span<BasicOceanState<float> *const> states);
+template void UpdateHeights(float t, Span<BasicOceanState<double> *const> states);
+template void QuantizeDispersion(BasicOceanState<float> &state, float period);
+template void QuantizeDispersion(BasicOceanState<double> &state, float period);
+template void SetupPhaseRotors(BasicOceanState<float> &state, float t0, float dt, int resyncInterval);
+template void SetupPhaseRotors(BasicOceanState<double> &state, float t0, float dt, int resyncInterval);
+template void StepHeights(BasicOceanState<float> &state);
+template void StepHeights(BasicOceanState<double> &state);
+template void StepHeights(Span<BasicOceanState<float> *const> states);
+template void StepHeights(Span<BasicOceanState<double> *const> states);
+template void InverseFourierTransform2D(Span<std::complex<float>> matrix, int size);
+template void InverseFourierTransform2D(Span<std::complex<double>> matrix, int size);
+template void InverseFourierTransform2DPacked(Span<std::complex<float>> a, Span<std::complex<float>> b, int size);
+template void InverseFourierTransform2DPacked(Span<std::complex<double>> a, Span<std::complex<double>> b, int size);
+template void normalizeHeightMap(Span<float> heightMap);
+template void normalizeHeightMap(Span<double> heightMap);
@@ -12,26 +12,124 @@
 #include <map>
 #include <string>
 #include <iomanip>
+#include "OceanState.hh"
+#include "Resolution.hh"
 
+#ifndef M_PI
 #define M_PI 3.14159265358979323846
-
-constexpr int RESOLUTION = 128;
+#endif
 
 struct Vector2
 {
     double x, y;
 
     Vector2(double _x, double _y) : x(_x), y(_y) {}
+
+    Vector2 operator*(double a) const { return Vector2(x * a, y * a); }
+    double dot(const Vector2 &other) const { return x * other.x + y * other.y; }
+    double magnitude() const { return sqrt(x * x + y * y); }
+
+    Vector2 normalize() const
+    {
+        double mag = magnitude();
+        return Vector2(x / mag, y / mag);
+    }
+};
+
+// Paramètres physiques du spectre de Phillips
+constexpr float GRAVITY = 9.81f;
+constexpr float WIND_SPEED = 12.4956;
+constexpr float PATCH_SIZE = 128;
+constexpr float CHOPPINESS = 1.01701;
+extern Vector2 WIND_DIRECTION;
+
+// Bornes des paramètres explorés par les balayages (voir ParameterSweep)
+constexpr float WIND_SPEED_MIN = 2.0;
+constexpr float WIND_SPEED_MAX = 12.0;
+constexpr float PATCH_SIZE_MIN = 64.0;
+constexpr float PATCH_SIZE_MAX = 256.0;
+constexpr float CHOPPINESS_MIN = 0.5;
+constexpr float CHOPPINESS_MAX = 1.5;
+
+// Paramètres d'un état de mer, par défaut ceux de la compilation
+struct OceanParameters
+{
+    float windSpeed = WIND_SPEED;
+    Vector2 windDirection = Vector2(-1, -1).normalize(); // Unitaire, comme WIND_DIRECTION
+    float choppiness = CHOPPINESS;
+    float patchSize = PATCH_SIZE;
+    // Part de l'énergie du spectre que GenerateSpectra peut écarter en annulant
+    // les cellules les plus faibles, pour évoluer et transformer moins de
+    // cellules à chaque frame. 0 : seules les cellules exactement nulles sont
+    // écartées, sans changer le résultat.
+    float pruneThreshold = 0;
+};
+
+// Cascades : plusieurs domaines de tailles différentes simulés ensemble (voir OceanCascades)
+constexpr int MAX_CASCADES = 4;
+
+// Bande de nombres d'onde simulée sur un domaine de patchSize mètres : seuls
+// les modes tels que minWaveNumber <= |k| < maxWaveNumber sont tirés
+struct SpectrumBand
+{
+    float patchSize = PATCH_SIZE;
+    float minWaveNumber = 0;
+    float maxWaveNumber = std::numeric_limits<float>::infinity();
 };
 
 typedef std::complex<double> Complex;
 typedef std::vector<Complex> CVector;
 typedef std::vector<std::vector<Complex>> CMatrix;
 
-CMatrix make_heightmap(int nb_img, int iter = 0);
-float heightmap_value(const float x, const float z, CMatrix heightmap);
-void GenerateSpectra(std::vector<Complex> &spectrum0, std::vector<float> &angularSpeeds);
-void UpdateHeights(float t, std::vector<Complex> &spectrum0, std::vector<Complex> &spectrum, std::vector<Complex> &choppinesses, std::vector<Complex> &choppinessDisplacements, std::vector<float> &heights, std::vector<float> &angularSpeeds);
-void normalizeHeightMap(CMatrix &heightMap);
+CMatrix make_heightmap(int nb_img, int iter = 0, int resolution = DEFAULT_RESOLUTION);
+// Hauteur au point (x, z) en cellules de la grille, répétée périodiquement.
+// Pour des requêtes en nombre ou en mètres, voir OceanSampler.
+float heightmap_value(float x, float z, const CMatrix &heightmap);
+template <typename Real>
+void GenerateSpectra(BasicOceanState<Real> &state);
+// Même tirage pour une même graine, quel que soit le nombre de threads :
+// utile pour répartir une animation entre processus
+template <typename Real>
+void GenerateSpectra(BasicOceanState<Real> &state, unsigned seed);
+// Spectre limité à band ; les amplitudes suivent le pas 2π / band.patchSize
+template <typename Real>
+void GenerateSpectra(BasicOceanState<Real> &state, unsigned seed, const SpectrumBand &band);
+// Spectre complet d'un état de mer quelconque, sur un domaine de parameters.patchSize
+// mètres ; la choppiness est retenue par l'état pour le jacobien
+template <typename Real>
+void GenerateSpectra(BasicOceanState<Real> &state, unsigned seed, const OceanParameters &parameters);
+// Spectre limité à band pour un état de mer quelconque (parameters.patchSize est ignoré)
+template <typename Real>
+void GenerateSpectra(BasicOceanState<Real> &state, unsigned seed, const SpectrumBand &band, const OceanParameters &parameters);
+// Hauteurs, déplacements, pentes et jacobien à l'instant t, en une IFFT groupée
+template <typename Real>
+void UpdateHeights(float t, BasicOceanState<Real> &state);
+// Plusieurs états de même résolution (cascades) évolués en une passe et
+// transformés par une seule IFFT groupée de 4 x states.size() champs
+template <typename Real>
+void UpdateHeights(float t, Span<BasicOceanState<Real> *const> states);
+// Rend l'animation périodique de période period (à appeler après GenerateSpectra)
+template <typename Real>
+void QuantizeDispersion(BasicOceanState<Real> &state, float period);
+// Évolution à pas fixe : les phases exp(iwt) sont avancées par multiplication
+// par des rotors exp(iw dt) et recalculées exactement tous les resyncInterval pas.
+template <typename Real>
+void SetupPhaseRotors(BasicOceanState<Real> &state, float t0, float dt, int resyncInterval = 256);
+template <typename Real>
+void StepHeights(BasicOceanState<Real> &state);
+template <typename Real>
+void StepHeights(Span<BasicOceanState<Real> *const> states);
+template <typename Real>
+void InverseFourierTransform2D(Span<std::complex<Real>> matrix, int size);
+void InverseFourierTransform2DReference(CMatrix &matrix);
+template <typename Real>
+void InverseFourierTransform2DPacked(Span<std::complex<Real>> a, Span<std::complex<Real>> b, int size);
+template <typename Real>
+void normalizeHeightMap(Span<Real> heightMap);
+// Image PPM (P6) complète, en-tête compris, dans bytes
+void encodePPM(Span<const float> heightMap, int size, std::vector<unsigned char> &bytes);
+void encodePPM(Span<const double> heightMap, int size, std::vector<unsigned char> &bytes);
+void writePPM(const std::string &filename, Span<const float> heightMap, int size);
+void writePPM(const std::string &filename, Span<const double> heightMap, int size);
 
 #endif // HEIGHTMAP_H
@@ -6,14 +6,29 @@
 #include <iostream>
 #include <vector>
 #include <complex>
+#include <memory>
+#include <cstdlib>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <random>
 #include "heightmap.hh"
 #include "Camera.hh"
+#include "ThreadPool.hh"
+#include "FrameCache.hh"
+#include "OceanCascades.hh"
+#include "Mesh.hh"
+#include "OceanRenderer.hh"
+#include "SimulationThread.hh"
+#include "Profiler.hh"
 
 typedef std::complex<double> Complex;
 typedef std::vector<Complex> CVector;
 typedef std::vector<std::vector<Complex>> CMatrix;
 
-Camera camera(0.0f, 0.0f, 30.0f);
+Camera camera(0.0f, 40.0f, 0.0f); // En cellules de la grille, au-dessus de la surface
 glm::vec3 sunPosition = glm::vec3(60.0f, 100.0f, 100.0f);
 GLfloat sunIntensity = 1.0f;
 glm::vec3 sunColor = glm::vec3(1.0f, 1.0f, 0.8f);
@@ -23,26 +38,30 @@ int currentTime = 0;  // Temps écoulé depuis le démarrage en millisecondes
 int previousTime = 0; // Temps précédent en millisecondes
 float fps = 0.0f;     // FPS (images par seconde)
 
-std::vector<Complex> spectrum0(RESOLUTION *RESOLUTION);
-std::vector<Complex> spectrum(RESOLUTION *RESOLUTION);
-std::vector<Complex> choppinesses(RESOLUTION *RESOLUTION);
-std::vector<Complex> choppinessDisplacements(RESOLUTION *RESOLUTION);
-std::vector<float> heights(RESOLUTION *RESOLUTION);
-std::vector<float> angularSpeeds(RESOLUTION *RESOLUTION);
-CMatrix heightMap(RESOLUTION, std::vector<Complex>(RESOLUTION));
-
-float t = 0.0f;
-
-GLuint program_id;
-
-void setupCamera()
-{
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glOrtho(0, RESOLUTION, 0, RESOLUTION, -200, 200);
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-}
+int resolution = DEFAULT_RESOLUTION; // Taille de la grille, choisie au démarrage
+int cascadeCount = 1; // Domaines superposés, du plus grand au domaine PATCH_SIZE
+std::unique_ptr<OceanCascades> ocean;
+
+unsigned seed = 0;    // Graine du spectre initial
+bool seeded = false; // Sans --seed, graine aléatoire à chaque lancement
+float pruneThreshold = 0.0f; // Part d'énergie du spectre que l'élagage peut écarter
+
+// Mode boucle : une période précalculée puis rejouée sans FFT
+float loopPeriod = 0.0f; // 0 : animation non périodique
+int loopFrames = 0;      // 0 : une frame toutes les 0.1 s de la période
+FrameCache frameCache;
+
+std::unique_ptr<VertexBuilder> vertexBuilder; // Utilisé par le thread de simulation
+std::unique_ptr<SimulationThread> simulation;
+double simulationRate = 60.0; // Pas de simulation par seconde
+double renderRate = 0.0;      // Images par seconde, 0 : sans limite
+int nextRenderTime = 0;       // En millisecondes, avec renderRate
+std::unique_ptr<OceanRenderer> renderer;
+std::unique_ptr<TileSelector> tileSelector;
+int viewTiles = 16; // Rayon du pavage autour de la caméra, en tuiles
+bool lighting = false; // Sommets complets (déplacements, normales) et éclairage diffus
+int frameLimit = 0;    // > 0 : quitte après frameLimit frames en affichant les compteurs de rendu
+int framesRendered = 0;
 
 void setupLighting()
 {
@@ -78,109 +97,12 @@ void setupOceanMaterial()
     glMaterialf(GL_FRONT, GL_SHININESS, shininess);
 }
 
-std::vector<GLfloat> convertToVertices(const CMatrix &heightmap)
-{
-    std::vector<GLfloat> vertices;
-    for (size_t i = 0; i < heightmap.size(); ++i)
-    {
-        for (size_t j = 0; j < heightmap[i].size(); ++j)
-        {
-            vertices.push_back(i);                           // x
-            vertices.push_back(heightmap[i][j].real() * 20); // y (hauteur)
-            vertices.push_back(j);                           // z
-        }
-    }
-    return vertices;
-}
-
-void drawVertices(const std::vector<GLfloat> &vertices)
-{
-    glBegin(GL_POINTS);
-    for (size_t i = 0; i < vertices.size(); i += 3)
-    {
-        GLfloat x = vertices[i];
-        GLfloat y = vertices[i + 1];
-        GLfloat z = vertices[i + 2];
-
-        // Définir les couleurs pour les différentes plages de hauteurs
-        GLfloat minHeight = 0.0f;
-        GLfloat maxHeight = 10;
-        GLfloat darkColor[3] = {0.0f, 0.0f, 1.0f};
-        GLfloat lightColor[3] = {0.0f, 0.0f, 0.2f};
-
-        // Calculer la valeur normalisée de la hauteur
-        GLfloat normalizedHeight = (y - minHeight) / (maxHeight - minHeight);
-
-        // Interpoler linéairement entre les couleurs définies
-        GLfloat color[3];
-        for (int j = 0; j < 3; ++j)
-        {
-            color[j] = darkColor[j] + normalizedHeight * (lightColor[j] - darkColor[j]);
-        }
-
-        glColor3fv(color);
-        glVertex3f(x, y, z);
-    }
-    glEnd();
-}
-
-std::vector<GLuint> generateIndices(const CMatrix &heightmap, size_t width, size_t height)
-{
-    std::vector<GLuint> indices;
-    for (size_t i = 0; i < height - 1; ++i)
-    {
-        for (size_t j = 0; j < width - 1; ++j)
-        {
-            // Triangle 1
-            indices.push_back(i * width + j);
-            indices.push_back((i + 1) * width + j);
-            indices.push_back(i * width + j + 1);
-
-            // Triangle 2
-            indices.push_back((i + 1) * width + j);
-            indices.push_back((i + 1) * width + j + 1);
-            indices.push_back(i * width + j + 1);
-        }
-    }
-    return indices;
-}
-
-void drawTriangles(const std::vector<GLfloat> &vertices, const std::vector<GLuint> &indices)
-{
-    // Définir les couleurs pour les différentes plages de hauteurs
-    GLfloat minHeight = 0.0f;
-    GLfloat maxHeight = 15.0f;
-    GLfloat darkColor[3] = {0.0f, 0.0f, 0.08f};
-    GLfloat lightColor[3] = {0.0f, 0.0f, 0.8f};
-
-    glBegin(GL_TRIANGLES);
-    for (size_t i = 0; i < indices.size(); ++i)
-    {
-        size_t index = indices[i];
-        GLfloat y = vertices[index * 3 + 1]; // y (hauteur)
-
-        // Calculer la valeur normalisée de la hauteur
-        GLfloat normalizedHeight = (y - minHeight) / (maxHeight - minHeight);
-
-        // Interpoler linéairement entre les couleurs définies
-        GLfloat color[3];
-        for (int j = 0; j < 3; ++j)
-        {
-            color[j] = darkColor[j] + normalizedHeight * (lightColor[j] - darkColor[j]);
-        }
-
-        glColor3fv(color);
-        glVertex3f(vertices[index * 3], y, vertices[index * 3 + 2]);
-    }
-    glEnd();
-}
-
 void keyboard(unsigned char key, int x, int y)
 {
-    const float movementSpeed = 0.1f; // Vitesse de déplacement de la caméra
-    float angleIncrement = 0.1f;
+    const float movementSpeed = 2.0f; // Vitesse de déplacement de la caméra, en cellules
+    float angleIncrement = 2.0f;       // En degrés
 
-    float zoomIncrement = 1.0f;
+    float zoomIncrement = 1.1f;
 
     switch (key)
     {
@@ -203,10 +125,16 @@ void keyboard(unsigned char key, int x, int y)
         camera.rotate(0.0f, angleIncrement, 0.0f); // Incliner la caméra vers le bas
         break;
     case 'r':
-        camera.rotate(0.0f, 0.0f, angleIncrement); // Faire pivoter la caméra vers la droite
+        camera.rotate(-angleIncrement, 0.0f, 0.0f); // Faire pivoter la caméra vers la droite
         break;
     case 'f':
-        camera.rotate(0.0f, 0.0f, -angleIncrement); // Faire pivoter la caméra vers la gauche
+        camera.rotate(angleIncrement, 0.0f, 0.0f); // Faire pivoter la caméra vers la gauche
+        break;
+    case 'w':
+        camera.moveForward(movementSpeed);
+        break;
+    case 'x':
+        camera.moveBackward(movementSpeed);
         break;
     case '+':
         camera.zoomIn(zoomIncrement); // Zoomer la caméra en réduisant le facteur de zoom
@@ -222,20 +150,16 @@ void keyboard(unsigned char key, int x, int y)
 
 void update()
 {
-    // Mettez à jour les paramètres nécessaires pour la scène
-    UpdateHeights(t, spectrum0, spectrum, choppinesses, choppinessDisplacements, heights, angularSpeeds);
-    t += 0.1;
-
-    // Convertir les hauteurs en une matrice 2D
-    for (int i = 0; i < RESOLUTION; ++i)
+    // La simulation tourne sur son propre thread : ici, seulement la cadence du rendu
+    if (renderRate > 0)
     {
-        for (int j = 0; j < RESOLUTION; ++j)
-        {
-            heightMap[i][j] = Complex(heights[i * RESOLUTION + j], 0.0);
-        }
+        const int now = glutGet(GLUT_ELAPSED_TIME);
+        if (now < nextRenderTime)
+            std::this_thread::sleep_for(std::chrono::milliseconds(nextRenderTime - now));
+        nextRenderTime = std::max(nextRenderTime, now) + static_cast<int>(1000.0 / renderRate);
     }
 
-    normalizeHeightMap(heightMap);
+    OCEAN_PROFILE_POLL();
 
     // Demandez à GLUT de redessiner la fenêtre
     glutPostRedisplay();
@@ -252,19 +176,17 @@ void drawSun()
 
 void display()
 {
-    glUseProgram(program_id);
     // Effacez le tampon de couleur et de profondeur
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glEnable(GL_POINT_SMOOTH);
-
-    glDisable(GL_DEPTH_TEST);
-
-    camera.update();
+    glEnable(GL_DEPTH_TEST);
 
-    // Dessinez la scène
-    std::vector<GLfloat> vertices = convertToVertices(heightMap);
-    std::vector<GLuint> indices = generateIndices(heightMap, RESOLUTION, RESOLUTION);
+    // Dessinez la scène : dernière frame simulée, renvoyée au GPU seulement si elle est nouvelle
+    if (const SimulatedFrame *frame = simulation->acquire())
+    {
+        OCEAN_PROFILE_SCOPE(STAGE_UPLOAD);
+        renderer->upload(Span<const GLfloat>(frame->vertices.data(), frame->vertices.size()));
+    }
 
     // glEnable(GL_LIGHTING);
     // glEnable(GL_LIGHT0);
@@ -281,11 +203,29 @@ void display()
 
     // drawSun();
 
-    drawVertices(vertices);
-    drawTriangles(vertices, indices);
+    const float aspect = static_cast<float>(glutGet(GLUT_WINDOW_WIDTH)) / std::max(glutGet(GLUT_WINDOW_HEIGHT), 1);
+    const glm::mat4 viewProjection = camera.projectionMatrix(aspect, 0.5f, tileSelector->farDistance()) * camera.viewMatrix();
+    const std::vector<TileDraw> *tiles;
+    {
+        OCEAN_PROFILE_SCOPE(STAGE_TILES);
+        tiles = &tileSelector->select(glm::vec3(camera.getX(), camera.getY(), camera.getZ()), viewProjection);
+    }
+
+    {
+        OCEAN_PROFILE_SCOPE(STAGE_DRAW);
+        renderer->draw(viewProjection, *tiles);
+    }
 
     // Échangez les tampons avant et arrière
-    glutSwapBuffers();
+    {
+        OCEAN_PROFILE_SCOPE(STAGE_SWAP);
+        glutSwapBuffers();
+    }
+    OCEAN_PROFILE_FRAME();
+
+    // Mode mesure (--frames) : les compteurs sont affichés par main() à la sortie de la boucle
+    if (frameLimit > 0 && ++framesRendered >= frameLimit)
+        glutLeaveMainLoop();
 
     // Comptez le nombre d'images affichées
     frameCount++;
@@ -296,7 +236,9 @@ void display()
     if (deltaTime > 1000) // Une seconde s'est écoulée
     {
         fps = frameCount / (deltaTime / 1000.0f);
-        std::cout << "FPS: " << fps << std::endl;
+        const HandoffStats handoff = simulation->stats();
+        std::cout << "FPS: " << fps << " | simulation : " << handoff.produced << " frames, " << handoff.dropped
+                  << " non affichées, latence moyenne " << handoff.meanLatencyMs << " ms" << std::endl;
 
         frameCount = 0;
         previousTime = currentTime;
@@ -310,12 +252,87 @@ void init_glut(int &argc, char *argv[])
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
     glutInitWindowSize(1024, 1024);
     glutCreateWindow("Ocean Simulator");
+    // glutMainLoop() rend la main à la fermeture, pour arrêter la simulation proprement
+    glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_GLUTMAINLOOP_RETURNS);
+
+}
+
+// Options restantes après glutInit : --threads N, --resolution N, --cascades N, --lighting 0|1,
+// --frames N, --sim-rate HZ, --render-rate HZ, --view-tiles N, --prune E
+bool parseArguments(int argc, char **argv)
+{
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        const std::string option = argv[i];
+        if (option == "--threads")
+            ThreadPool::shared().setThreadCount(std::atoi(argv[++i]));
+        else if (option == "--resolution")
+            resolution = std::atoi(argv[++i]);
+        else if (option == "--cascades")
+            cascadeCount = std::atoi(argv[++i]);
+        else if (option == "--seed")
+        {
+            seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+            seeded = true;
+        }
+        else if (option == "--loop")
+            loopPeriod = static_cast<float>(std::atof(argv[++i]));
+        else if (option == "--loop-frames")
+            loopFrames = std::atoi(argv[++i]);
+        else if (option == "--lighting")
+            lighting = std::atoi(argv[++i]) != 0;
+        else if (option == "--frames")
+            frameLimit = std::atoi(argv[++i]);
+        else if (option == "--sim-rate")
+            simulationRate = std::atof(argv[++i]);
+        else if (option == "--render-rate")
+            renderRate = std::atof(argv[++i]);
+        else if (option == "--view-tiles")
+            viewTiles = std::atoi(argv[++i]);
+        else if (option == "--prune")
+            pruneThreshold = static_cast<float>(std::atof(argv[++i]));
+    }
 
+    if (cascadeCount < 1 || cascadeCount > MAX_CASCADES)
+    {
+        std::cerr << "--cascades doit être compris entre 1 et " << MAX_CASCADES << std::endl;
+        return false;
+    }
+    if (cascadeCount > 1 && loopPeriod > 0)
+    {
+        std::cerr << "--loop ne rejoue qu'une cascade : incompatible avec --cascades" << std::endl;
+        return false;
+    }
+    if (!(pruneThreshold >= 0 && pruneThreshold < 1))
+    {
+        std::cerr << "--prune doit être compris dans [0, 1)" << std::endl;
+        return false;
+    }
+    if (viewTiles < 0)
+    {
+        std::cerr << "--view-tiles doit être positif ou nul" << std::endl;
+        return false;
+    }
+    if (!(simulationRate > 0) || renderRate < 0)
+    {
+        std::cerr << "Fréquences invalides : --sim-rate > 0 et --render-rate >= 0 attendus" << std::endl;
+        return false;
+    }
+    if (!isSupportedResolution(resolution))
+    {
+        std::cerr << "Résolution non supportée : puissance de deux entre "
+                  << MIN_RESOLUTION << " et " << MAX_RESOLUTION << " attendue" << std::endl;
+        return false;
+    }
+    return true;
 }
 
 int main(int argc, char **argv)
 {
     init_glut(argc, argv);
+    if (!parseArguments(argc, argv))
+        return -1;
+    OCEAN_PROFILE_INIT("ocean_profile"); // Sans effet si OCEAN_PROFILING n'est pas défini
     // Initialisez GLEW
     glewExperimental = GL_TRUE;
     if (glewInit() != GLEW_OK)
@@ -325,11 +342,45 @@ int main(int argc, char **argv)
     }
 
     // Définir la fonction de rappel d'affichage
-    GenerateSpectra(spectrum0, angularSpeeds);
+    ocean.reset(new OceanCascades(resolution, cascadeCount));
+    // Sans éclairage, seules les hauteurs sont transmises : x et z viennent de la grille statique
+    const VertexFormat format = lighting ? VERTEX_POSITION_NORMAL : VERTEX_HEIGHT;
+    vertexBuilder.reset(new VertexBuilder(resolution, ocean->getPatchSize() / resolution, CHOPPINESS, format));
+    // Niveaux de détail jusqu'à une cellule par tuile ; le niveau 0 jusqu'à une tuile de distance
+    const int levelCount = TileTopology::maxLevelCount(resolution);
+    renderer.reset(new OceanRenderer(resolution, format, levelCount));
+    tileSelector.reset(new TileSelector(resolution, levelCount, viewTiles, static_cast<float>(resolution), 0.0f,
+                                        VERTEX_HEIGHT_SCALE, 0.0625f * resolution));
+    renderer->setSunDirection(sunPosition.x, sunPosition.y, sunPosition.z);
+    OceanParameters parameters;
+    parameters.pruneThreshold = pruneThreshold;
+    ocean->generate(seeded ? seed : std::random_device()(), parameters);
+    std::size_t activeCells = 0;
+    double discardedEnergy = 0;
+    for (int c = 0; c < ocean->getCascadeCount(); ++c)
+    {
+        const OceanStateF::SpectrumPruning &pruning = ocean->cascade(c).spectrumPruning();
+        activeCells += pruning.activeCells;
+        discardedEnergy = std::max(discardedEnergy, pruning.discardedEnergy);
+        if (pruneThreshold > 0)
+            std::cout << "Cascade " << c << " : " << 100.0 * pruning.activeCells / ocean->cascade(c).cellCount() << " % des cellules évoluées, "
+                      << pruning.activeRows << " lignes sur " << resolution << " transformées en première passe, énergie écartée "
+                      << pruning.discardedEnergy << std::endl;
+    }
+    if (loopPeriod > 0)
+    {
+        QuantizeDispersion(ocean->cascade(0), loopPeriod);
+        if (loopFrames <= 0)
+            loopFrames = std::max(1, static_cast<int>(std::lround(loopPeriod / 0.1f)));
+        frameCache.build(ocean->cascade(0), loopPeriod, loopFrames);
+        std::cout << "Boucle de " << loopPeriod << " s : " << loopFrames << " frames en cache ("
+                  << frameCache.byteSize() / (1024 * 1024) << " Mo)" << std::endl;
+    }
+    // Initialise les rotors de phase au pas 1 / simulationRate hors mode boucle
+    simulation.reset(new SimulationThread(*ocean, frameCache, *vertexBuilder, simulationRate));
     glutDisplayFunc(display);
 
     camera.init();
-    setupCamera();
 
     glutKeyboardFunc(keyboard);
 
@@ -338,6 +389,21 @@ int main(int argc, char **argv)
 
     // Boucle principale de rendu
     glutMainLoop();
+    const HandoffStats handoff = simulation->stats();
+    simulation.reset(); // Avant la destruction du pool de threads partagé
 
+    if (frameLimit > 0)
+    {
+        const RenderStats &last = renderer->lastFrame();
+        const RenderStats &total = renderer->total();
+        std::cout << "{\"frames\": " << total.frames << ", \"persistent\": " << (renderer->isPersistent() ? "true" : "false")
+                  << ", \"draw_calls_per_frame\": " << last.drawCalls << ", \"bytes_uploaded_per_frame\": " << last.bytesUploaded
+                  << ", \"triangles_per_frame\": " << last.triangles << ", \"tiles_culled\": " << tileSelector->lastSelection().culled
+                  << ", \"draw_calls\": " << total.drawCalls << ", \"bytes_uploaded\": " << total.bytesUploaded
+                  << ", \"fence_waits\": " << total.fenceWaits << ", \"simulated_frames\": " << handoff.produced
+                  << ", \"dropped_frames\": " << handoff.dropped << ", \"handoff_latency_mean_ms\": " << handoff.meanLatencyMs
+                  << ", \"handoff_latency_max_ms\": " << handoff.maxLatencyMs << ", \"spectrum_active_cells\": " << activeCells
+                  << ", \"spectrum_discarded_energy\": " << discardedEnergy << "}" << std::endl;
+    }
     return 0;
 }
\ No newline at end of file